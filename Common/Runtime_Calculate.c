@@ -8,6 +8,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "Runtime_Calculate.h"
+#include "tim.h"
 
 /* External function declaration----------------------------------------------*/
 
@@ -75,3 +76,56 @@ t_FuncRet Runtime_Calculate_Finish_Hardware(void)
     return ret;
 }
 
+/** 
+* @description: Start the free-running timestamp timer, TIM5 counts from 0 at 1MHz without interrupt
+* @param  {void} 
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Timestamp_Init(void)
+{
+    t_FuncRet ret= (t_FuncRet)Operation_Success;
+    
+    __HAL_TIM_SET_COUNTER(&htim5, 0);
+    
+    if(HAL_TIM_Base_Start(&htim5) != HAL_OK)
+    {
+        ret= (t_FuncRet)Operation_Fail;
+    }
+    
+    return ret;
+}
+
+/** 
+* @description: Return the current timestamp
+* @param  {void} 
+* @return {uint32_t} : Timestamp, unit: us
+* @author: leeqingshui 
+*/
+uint32_t Get_Timestamp_Us(void)
+{
+    return GET_TIMESTAMP_US();
+}
+
+/** 
+* @description: Start the DWT cycle counter, it counts core clock cycles from 0 without interrupt.
+*				A measurement is GET_CYCLE_COUNT() after minus GET_CYCLE_COUNT() before (unsigned, wraps safely)
+* @param  {void} 
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Cycle_Counter_Init(void)
+{
+    t_FuncRet ret= (t_FuncRet)Operation_Success;
+    
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT       = 0;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+    
+    if((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+    {
+        ret= (t_FuncRet)Operation_Fail;
+    }
+    
+    return ret;
+}
@@ -3,6 +3,8 @@
   * File Name          : Runtime_Calculate.h
   * Description        : This file mainly includes the function running measurement function and its macro definition: 
   *                      the function running time is obtained mainly by measuring the GPIO turning time
+  *                      It also provides the free-running 1MHz timestamp (TIM5, 32 bits, wraps every 71.6 minutes)
+  *                      shared by all acquisition streams
   ******************************************************************************
   */
 
@@ -24,6 +26,14 @@
 #define RUNTIME_TEST_GPIO_Pin           GPIO_PIN_0
 #define RUNTIME_TEST_GPIO_GPIO_Port     GPIOB
 
+/* Timer of the timestamp: TIM5 counts at 1MHz (APB1 timer clock 72MHz, PSC:72-1) */
+#define TIMESTAMP_TIM                   TIM5
+/* Read the current timestamp, unit: us. Cheap enough to be used in every interrupt */
+#define GET_TIMESTAMP_US()              (TIMESTAMP_TIM->CNT)
+
+/* Read the DWT cycle counter (core clock, wraps every 59.6 s at 72MHz), used to benchmark the DSP kernels */
+#define GET_CYCLE_COUNT()               (DWT->CYCCNT)
+
 /* Extern Variable------------------------------------------------------------*/
 
 /* Data structure declaration-------------------------------------------------*/
@@ -39,6 +49,14 @@ t_FuncRet Runtime_Calculate_Start_Hardware(void);
 /* Measure function finish (measured by measuring the GPIO port turn time) - Pull down the GPIO port level */
 t_FuncRet Runtime_Calculate_Finish_Hardware(void); 
 
+/* Start the free-running timestamp timer */
+t_FuncRet Timestamp_Init(void);
+/* Return the current timestamp, unit: us */
+uint32_t Get_Timestamp_Us(void);
+
+/* Start the DWT cycle counter */
+t_FuncRet Cycle_Counter_Init(void);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,142 @@
+/**
+  ******************************************************************************
+  * File Name          : SampleRing_Buffer.c
+  * Description        : This file contains the lock-free single-producer/single-consumer 
+  *                      ring buffer of multichannel sample frames.
+  *                      Head and Tail are free running counters, the frame slot is Count & Mask,
+  *                      the number of frames in the ring is Head - Tail (unsigned wrap is fine).
+  *                      __DMB makes the frame data visible before the counter that publishes it.
+  ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "SampleRing_Buffer.h"
+
+/* External function declaration----------------------------------------------*/
+
+
+/* Private macro definitions--------------------------------------------------*/
+
+
+/* Global variable------------------------------------------------------------*/
+
+
+/* Static function definition-------------------------------------------------*/
+
+
+/* Function definition--------------------------------------------------------*/
+
+/** 
+* @description: Initialize the ring on a frame array
+* @param  {SampleRing*}   p_Ring   : Ring structure pointer
+* @param  {Sample_Frame*} p_Buffer : Frame storage
+* @param  {uint32_t}      Size     : Number of frames in p_Buffer, must be a power of 2
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet SampleRing_Init(SampleRing* p_Ring, Sample_Frame* p_Buffer, uint32_t Size)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((p_Ring == NULL) || (p_Buffer == NULL) || !IS_SAMPLE_RING_SIZE(Size))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	p_Ring->p_Buffer      = p_Buffer;
+	p_Ring->Size          = Size;
+	p_Ring->Mask          = Size - 1;
+	p_Ring->Head          = 0;
+	p_Ring->Tail          = 0;
+	p_Ring->Overrun_Count = 0;
+	p_Ring->High_Water    = 0;
+	
+	return ret;
+}
+
+/** 
+* @description: Push one frame, called only by the producer (interrupt).
+*				If the ring is full the frame is dropped and counted, the frames already 
+*				in the ring are never overwritten
+* @param  {SampleRing*}   p_Ring  : Ring structure pointer
+* @param  {Sample_Frame*} p_Frame : Frame to be copied into the ring
+* @return {t_FuncRet } : if success,return Operation_Success, Operation_Fail if the ring is full
+* @author: leeqingshui 
+*/
+t_FuncRet SampleRing_Push(SampleRing* p_Ring, const Sample_Frame* p_Frame)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	uint32_t Head  = p_Ring->Head;
+	uint32_t Count = Head - p_Ring->Tail;
+	
+	if(Count >= p_Ring->Size)
+	{
+		p_Ring->Overrun_Count++;
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	p_Ring->p_Buffer[Head & p_Ring->Mask] = *p_Frame;
+	
+	/* The frame must be written before the consumer can see the new Head */
+	__DMB();
+	p_Ring->Head = Head + 1;
+	
+	if(Count + 1 > p_Ring->High_Water)
+	{
+		p_Ring->High_Water = Count + 1;
+	}
+	
+	return ret;
+}
+
+/** 
+* @description: Pop one frame, called only by the consumer (main loop)
+* @param  {SampleRing*}   p_Ring  : Ring structure pointer
+* @param  {Sample_Frame*} p_Frame : The oldest frame in the ring
+* @return {t_FuncRet } : if success,return Operation_Success, Operation_Wait if the ring is empty
+* @author: leeqingshui 
+*/
+t_FuncRet SampleRing_Pop(SampleRing* p_Ring, Sample_Frame* p_Frame)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	uint32_t Tail = p_Ring->Tail;
+	
+	if(p_Ring->Head == Tail)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	/* Head is read before the frame it publishes */
+	__DMB();
+	*p_Frame = p_Ring->p_Buffer[Tail & p_Ring->Mask];
+	
+	/* The frame must be read before the producer can reuse the slot */
+	__DMB();
+	p_Ring->Tail = Tail + 1;
+	
+	return ret;
+}
+
+/** 
+* @description: Return the number of frames waiting in the ring
+* @param  {SampleRing*} p_Ring : Ring structure pointer
+* @return {uint32_t}           : Number of frames
+* @author: leeqingshui 
+*/
+uint32_t SampleRing_Get_Count(const SampleRing* p_Ring)
+{
+	return p_Ring->Head - p_Ring->Tail;
+}
+
+/** 
+* @description: Return the number of frames dropped because the ring was full
+* @param  {SampleRing*} p_Ring : Ring structure pointer
+* @return {uint32_t}           : Number of dropped frames
+* @author: leeqingshui 
+*/
+uint32_t SampleRing_Get_Overrun(const SampleRing* p_Ring)
+{
+	return p_Ring->Overrun_Count;
+}
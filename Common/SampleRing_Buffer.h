@@ -0,0 +1,84 @@
+/**
+  ******************************************************************************
+  * File Name          : SampleRing_Buffer.h
+  * Description        : This file contains the lock-free single-producer/single-consumer 
+  *                      ring buffer of multichannel sample frames.
+  *                      The producer (ADC interrupt) only writes Head, the consumer (main loop) 
+  *                      only writes Tail, so no interrupt has to be disabled on either side.
+  *                      When the ring is full the newest frame is dropped and counted as overrun.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SAMPLERING_BUFFER_H
+#define __SAMPLERING_BUFFER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "numtype.h"
+
+/* Common macro definitions---------------------------------------------------*/
+
+/* Number of EMG channels in one sample frame */
+#define SAMPLE_FRAME_CHANNEL_NUM        4
+
+/* Macro function to determine whether the ring size is a power of 2 */
+#define IS_SAMPLE_RING_SIZE(SIZE)       (((SIZE) != 0) && (((SIZE) & ((SIZE) - 1)) == 0))
+
+/* Extern Variable------------------------------------------------------------*/
+
+/* Data structure declaration-------------------------------------------------*/
+
+/* One timestamped multichannel sample frame */
+typedef struct
+{
+	/* Index of the frame since sampling started, continuous unless frames are dropped */
+	uint32_t SampleIndex;
+	/* Acquisition time of the frame (free-running 1MHz timestamp), unit: us */
+	uint32_t Timestamp;
+	/* Voltage of every EMG channel, unit: mV */
+	uint16_t Data[SAMPLE_FRAME_CHANNEL_NUM];
+	/* Voltage of Vref, unit: mV */
+	uint16_t Vref;
+}Sample_Frame;
+
+/* Single-producer/single-consumer ring of sample frames */
+typedef struct
+{
+	/* Frame storage, Size elements */
+	Sample_Frame*     p_Buffer;
+	/* Number of frames, a power of 2 */
+	uint32_t          Size;
+	/* Size - 1, the index of a frame is Count & Mask */
+	uint32_t          Mask;
+	/* Number of frames pushed, written only by the producer */
+	volatile uint32_t Head;
+	/* Number of frames popped, written only by the consumer */
+	volatile uint32_t Tail;
+	/* Number of frames dropped because the ring was full, written only by the producer */
+	volatile uint32_t Overrun_Count;
+	/* Largest number of frames ever waiting in the ring */
+	volatile uint32_t High_Water;
+}SampleRing;
+
+/* Function declaration-------------------------------------------------------*/
+
+/* Initialize the ring on a frame array */
+t_FuncRet SampleRing_Init(SampleRing* p_Ring, Sample_Frame* p_Buffer, uint32_t Size);
+/* Push one frame, called only by the producer */
+t_FuncRet SampleRing_Push(SampleRing* p_Ring, const Sample_Frame* p_Frame);
+/* Pop one frame, called only by the consumer */
+t_FuncRet SampleRing_Pop(SampleRing* p_Ring, Sample_Frame* p_Frame);
+/* Return the number of frames waiting in the ring */
+uint32_t SampleRing_Get_Count(const SampleRing* p_Ring);
+/* Return the number of frames dropped because the ring was full */
+uint32_t SampleRing_Get_Overrun(const SampleRing* p_Ring);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __SAMPLERING_BUFFER_H */
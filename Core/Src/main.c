@@ -239,6 +239,7 @@ int main(void)
   MX_TIM2_Init();
   MX_TIM3_Init();
   MX_TIM4_Init();
+  MX_TIM5_Init();
   MX_USB_DEVICE_Init();
   /* USER CODE BEGIN 2 */
   
@@ -272,6 +273,26 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
+    
+    /* Execute the commands received from the upper computer */
+    Command_Process();
+    
+    /* Apply the sampling profile requested by the upper computer and report the achieved rate back */
+    if(ADC_SampleProfile_Process() != Operation_Wait)
+    {
+        SendSampleProfileToPC();
+    }
+    
+    /* Drain the ADC sample ring filled in the DMA interrupt and send the frames to the upper computer in batches */
+    SendADCBatchToPC();
+    
+    /* Send the gyroscope data filtered in the timer 4 interrupt, timestamped for the alignment with the ADC frames */
+    SendMotionDataToPC();
+    
+    /* EMG blocks queued in the DMA interrupt: filtered, and 50% overlapped windows analyzed for the spectral features */
+    ADC_EMG_Block_Process();
+    SendSpectrumToPC();
+    
     HMI_Function_Test();
   }
   /* USER CODE END 3 */
@@ -335,6 +356,22 @@ t_FuncRet Hardware_Init(void)
 	HAL_Delay(500);
 	printf("====The system starts to initialize hardware====\r\n");
 	
+	/* Start the 1MHz timestamp shared by the ADC frames and the gyroscope packets */
+	ret = Timestamp_Init();
+	if(ret == Operation_Fail)
+	{
+		printf("Failed to initialize Timestamp\r\n");
+		Error_Handler();
+	}
+	
+	/* Start the cycle counter used to benchmark the DSP kernels */
+	ret = Cycle_Counter_Init();
+	if(ret == Operation_Fail)
+	{
+		printf("Failed to initialize Cycle Counter\r\n");
+		Error_Handler();
+	}
+	
 	/* Initialize ADC related peripherals: ADC GPIO port and DMA channel*/
     /* The interruption of timer 2 was enabled */
     /* 
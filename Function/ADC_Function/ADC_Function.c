@@ -10,60 +10,228 @@
 #include "ADC_Function.h"
 #include "ADC_Operation.h"
 #include "DigtalSignal_Process.h"
+#include "SampleRing_Buffer.h"
+#include "string.h"
+#include "math.h"
 
 /* External function declaration----------------------------------------------*/
 
 /* Obtain the voltage values collected by the 2 channels */
 extern t_FuncRet ADC_Get_Data(void);
-/* Obtain the voltage of no. 1 EMG sensor */
-extern t_FuncRet ADC_Get_SensorData_1(uint16_t* p_Sensor_V_Data);
-/* Obtain the voltage of no. 2 EMG sensor */
-extern t_FuncRet ADC_Get_SensorData_2(uint16_t* p_Sensor_V_Data);
-/* Obtain the voltage of no. 3 EMG sensor */
-extern t_FuncRet ADC_Get_SensorData_3(uint16_t* p_Sensor_V_Data);
-/* Obtain the voltage of no. 4 EMG sensor */
-extern t_FuncRet ADC_Get_SensorData_4(uint16_t* p_Sensor_V_Data);
-/* Obtain the voltage of Vref */
-extern t_FuncRet ADC_Get_Vref(uint16_t* p_Vref);
-
-/* Mean filtering function */
-extern uint16_t Data_Mean_Filter_U16(Mean_Filter_U16* p_MeanFilterStruct,uint16_t Temp_Data_Buf[]);
-/* Mean filtering Reset function */
-extern void Mean_Filter_Rest_U16(Mean_Filter_U16* p_MeanFilterStruct);
-
-/* Initialize the Kalman filter */
-extern void KalmanFilter_Init(Kalman_Filter* p_Kalman_Filter);
-/* Data were filtered by Kalman filter */
-extern float KalmanFilter_Calculate(Kalman_Filter* p_Kalman_Filter , float InData);
+
+/* Initialize the moving average filter */
+extern t_FuncRet Moving_Average_Init_U16(Moving_Average_U16* p_Filter, uint16_t Window);
+/* Filter one sample by the moving average filter */
+extern uint16_t Moving_Average_Update_U16(Moving_Average_U16* p_Filter, uint16_t InData);
+
+/* Initialize the Kalman filter bank */
+extern t_FuncRet KalmanFilter_Bank_Init(Kalman_Filter_Bank* p_Bank, uint32_t Channel_Num);
+/* One frame (one sample of every channel) is filtered by the Kalman filter bank */
+extern void KalmanFilter_Bank_Calculate(Kalman_Filter_Bank* p_Bank, const float* p_InData, float* p_OutData);
+/* Give every channel of the Kalman filter bank its steady state gain */
+extern void KalmanFilter_Bank_Set_Steady(Kalman_Filter_Bank* p_Bank);
+/* Filter a block of samples of one channel by the Kalman filter bank */
+extern void KalmanFilter_Bank_Process_U16(Kalman_Filter_Bank* p_Bank, uint32_t Channel, const uint16_t* p_SrcBuff, uint32_t Stride, float* p_DstBuff, uint32_t Block_Size);
+
+/* Design the coefficients of one second order stage (RBJ audio EQ cookbook) */
+extern t_FuncRet Biquad_Design(Biquad_Type Type, float32_t Sample_Rate, float32_t F0, float32_t Q, float32_t* p_Coeffs);
+/* Load a coefficient set into the floating point biquad cascade and clear its state */
+extern t_FuncRet Biquad_Cascade_Init_F(Biquad_Cascade_F* p_Cascade, const float32_t* p_Coeffs, uint8_t Stage_Num);
+/* Filter a block of samples by the floating point biquad cascade */
+extern void Biquad_Cascade_Process_F(Biquad_Cascade_F* p_Cascade, const float32_t* p_SrcBuff, float32_t* p_DstBuff, uint32_t Block_Size);
+
+/* Prepare the Hann window and the FFT tables of the spectrum analyzer */
+extern t_FuncRet Spectrum_Init(Spectrum_Analyzer* p_Spectrum, uint16_t FFT_Size, float32_t Sample_Rate);
+/* Window and transform FFT_Size samples, and compute the mean frequency, median frequency and band powers */
+extern t_FuncRet Spectrum_Get_Features(Spectrum_Analyzer* p_Spectrum, const float32_t* p_SrcBuff, 
+									   const float32_t* p_Band_Edges, uint8_t Band_Num, Spectrum_Features* p_Features);
+
+/* Choose the bins of the sliding DFT bank and clear its history */
+extern t_FuncRet Sliding_DFT_Bank_Init(Sliding_DFT_Bank* p_Bank, uint16_t Window, float32_t Sample_Rate, const float32_t* p_Freq, uint8_t Bin_Num);
+/* Update every bin of the sliding DFT bank with a block of samples */
+extern void Sliding_DFT_Bank_Process(Sliding_DFT_Bank* p_Bank, const float32_t* p_SrcBuff, uint32_t Block_Size);
+/* Get the amplitude of the sinusoid in every bin of the sliding DFT bank */
+extern void Sliding_DFT_Bank_Get_Magnitude(const Sliding_DFT_Bank* p_Bank, float32_t* p_Magnitude);
+
+/* Prepare the EMG linear envelope filter and clear its state */
+extern t_FuncRet Envelope_Filter_Init(Envelope_Filter* p_Filter, float32_t Sample_Rate, float32_t Cutoff_Hz, float32_t Baseline_Hz, uint16_t Decimation);
+/* Filter a block of uint16_t samples into the decimated envelope */
+extern uint32_t Envelope_Filter_Process_U16(Envelope_Filter* p_Filter, const uint16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, float32_t* p_DstBuff);
+
+/* Design the low pass of a Q15 polyphase resampler */
+extern t_FuncRet Polyphase_FIR_Design_Q15(uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, int16_t* p_Coeffs);
+/* Prepare a Q15 polyphase resampler and clear its delay line */
+extern t_FuncRet Polyphase_FIR_Init_Q15(Polyphase_FIR_Q15* p_Resampler, uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, 
+										const int16_t* p_Coeffs, int16_t* p_State);
+/* Resample a block of Q15 samples */
+extern uint32_t Polyphase_FIR_Process_Q15(Polyphase_FIR_Q15* p_Resampler, const int16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, int16_t* p_DstBuff);
 
 /* Private macro definitions--------------------------------------------------*/
 
+/* Quality factors of the two stages of a 4th order Butterworth filter */
+#define BUTTERWORTH_4TH_Q1              0.5412f
+#define BUTTERWORTH_4TH_Q2              1.3066f
+
+/* Pi, for the droop of the average feeding the tone tracking */
+#define ADC_EMG_PI                      3.14159265358979f
+
 /* Global variable------------------------------------------------------------*/
 
-/* Cache array of ADC voltage acquisition results */
-static uint16_t Sensor_No1_DataBuf[MEAN_FILTER_NUM];
-static uint16_t Sensor_No2_DataBuf[MEAN_FILTER_NUM];
-static uint16_t Sensor_No3_DataBuf[MEAN_FILTER_NUM];
-static uint16_t Sensor_No4_DataBuf[MEAN_FILTER_NUM];
-static uint16_t Sensor_Vref_DataBuf[MEAN_FILTER_NUM];
-/* Array index */
-static uint8_t DataBuf_Index = 0;
-
-/* Voltage value Kalman filter structure */
-static Kalman_Filter KalmanFilterStruct_Sensor_No1 = {0};
-static Kalman_Filter KalmanFilterStruct_Sensor_No2 = {0};
-static Kalman_Filter KalmanFilterStruct_Sensor_No3 = {0};
-static Kalman_Filter KalmanFilterStruct_Sensor_No4 = {0};
-static Kalman_Filter KalmanFilterStruct_Sensor_Vref= {0};
+/* Moving average filter of every channel view: sensor 1 - 4, Vref */
+static Moving_Average_U16 Sensor_MeanFilter[ADC_CHANNEL_ID_NUM];
+/* Determines whether the moving average filters are initialized */
+static bool MeanFilterInitFlag = (bool)FALSE;
+
+/* Voltage value Kalman filter bank: sensor 1 - 4, Vref */
+static Kalman_Filter_Bank KalmanFilterBank_Sensor = {0};
 /* Determines whether the Kalman filter structure is initialized */
 static bool KalmanFilterInitFlag = (bool)FALSE;
 
+/* Kalman filter bank of the block path, started at the steady state gain */
+static Kalman_Filter_Bank KalmanFilterBank_Block = {0};
+/* Determines whether the block Kalman filter bank is initialized */
+static bool KalmanBlockInitFlag = (bool)FALSE;
+
+/* Latest block of DMA frames handed over by the ADC layer */
+static uint16_t* volatile p_ADC_Block       = NULL;
+static volatile uint32_t  ADC_Block_FrameNum = 0;
+/* Set when a new block arrives, cleared when the block is read */
+static volatile bool      ADC_BlockReady_Flag = (bool)FALSE;
+
+/* Oversampled output of every rank, a ring per rank between the DMA interrupt (producer) and the main loop (consumer) */
+static uint16_t          ADC_Oversampled_Ring[ADC_SCAN_RANK_NUM][ADC_OVERSAMPLED_RING_SIZE];
+static volatile uint32_t ADC_Oversampled_Head[ADC_SCAN_RANK_NUM] = {0};
+static volatile uint32_t ADC_Oversampled_Tail[ADC_SCAN_RANK_NUM] = {0};
+/* Number of oversampled samples dropped because the ring of the rank was full */
+static uint32_t          ADC_Oversampled_Overrun[ADC_SCAN_RANK_NUM] = {0};
+/* Oversampled output of one rank of the latest block before it goes into the ring */
+static uint16_t          ADC_Oversampled_Block[ADC_BLOCK_FRAME_MAX_NUM];
+/* Ranks oversampled by Set_ADC_Oversampling (ratio above 1), and their newest oversampled voltage (0 if none yet), unit: mV */
+static bool              ADC_Oversampled_Used[ADC_SCAN_RANK_NUM] = {(bool)FALSE};
+static uint16_t          ADC_Oversampled_mVolt[ADC_SCAN_RANK_NUM] = {0};
+
+/* Biquad cascade of every EMG channel and the coefficient set in use */
+static Biquad_Cascade_F   ADC_EMG_Filter[ADC_EMG_CHANNEL_NUM];
+static ADC_EMG_Filter_ID  ADC_EMG_Filter_ID_Used   = ADC_EMG_FILTER_NONE;
+/* Sampling rate the coefficients were designed for, 0 if not designed yet */
+static uint32_t           ADC_EMG_Filter_Rate      = 0;
+/* Cycles per sample spent by the last cascade call */
+static uint32_t           ADC_EMG_Filter_Cycles    = 0;
+/* Filtered samples of the latest processed block and whether they have been read */
+static float32_t          ADC_EMG_Filtered_DataBuf[ADC_EMG_CHANNEL_NUM][ADC_BLOCK_FRAME_MAX_NUM];
+static uint32_t           ADC_EMG_Filtered_Num = 0;
+static bool               ADC_EMG_Filtered_Ready[ADC_EMG_CHANNEL_NUM] = {(bool)FALSE};
+
+/* 
+	EMG blocks: written in the DMA interrupt at ADC_EMG_Block_Tail, 
+	read in the main loop at ADC_EMG_Block_Head, one slot is kept empty
+*/
+static ADC_EMG_Block      ADC_EMG_Block_Queue[ADC_EMG_BLOCK_QUEUE_NUM + 1];
+static volatile uint8_t   ADC_EMG_Block_Head = 0;
+static volatile uint8_t   ADC_EMG_Block_Tail = 0;
+/* Index of the frame following the last processed block, a block starting elsewhere comes after a gap */
+static uint32_t           ADC_EMG_Block_Next_Index = 0;
+
+/* Sliding DFT bank of every EMG channel and the tracked tones, unit: Hz */
+static Sliding_DFT_Bank   ADC_EMG_Tone_Bank[ADC_EMG_CHANNEL_NUM];
+static const float32_t    ADC_EMG_Tone_Freq[ADC_EMG_TONE_NUM] = {50.0f, 60.0f, 100.0f, 250.0f};
+/* Sampling rate the banks were prepared for, 0 if not prepared yet */
+static uint32_t           ADC_EMG_Tone_Rate = 0;
+/* Number of samples averaged into one sample of the banks, the partial sum of every channel and the samples in it */
+static uint32_t           ADC_EMG_Tone_Decimation = 1;
+static uint32_t           ADC_EMG_Tone_Sum[ADC_EMG_CHANNEL_NUM] = {0};
+static uint32_t           ADC_EMG_Tone_Count = 0;
+/* Gain making up for the droop of the average at every tone */
+static float32_t          ADC_EMG_Tone_Gain[ADC_EMG_TONE_NUM];
+/* Averaged samples of one channel of a block, kept off the stack (0x800 bytes) */
+static float32_t          ADC_EMG_Tone_Block[ADC_BLOCK_FRAME_MAX_NUM];
+
+/* Linear envelope filter of every EMG channel */
+static Envelope_Filter    ADC_EMG_Envelope_Filter[ADC_EMG_CHANNEL_NUM];
+/* Sampling rate the filters were prepared for, 0 if not prepared yet */
+static uint32_t           ADC_EMG_Envelope_Rate = 0;
+/* Envelope samples produced from the latest processed block and whether they have been read */
+static float32_t          ADC_EMG_Envelope_DataBuf[ADC_EMG_CHANNEL_NUM][ADC_BLOCK_FRAME_MAX_NUM];
+static uint32_t           ADC_EMG_Envelope_Num[ADC_EMG_CHANNEL_NUM] = {0};
+static bool               ADC_EMG_Envelope_Ready[ADC_EMG_CHANNEL_NUM] = {(bool)FALSE};
+
+/* Resampler of every EMG channel to ADC_EMG_ALIGNED_RATE_HZ, one coefficient set shared by the channels */
+static Polyphase_FIR_Q15  ADC_EMG_Aligned_Resampler[ADC_EMG_CHANNEL_NUM];
+static int16_t            ADC_EMG_Aligned_Coeffs[ADC_EMG_ALIGNED_TAPS_MAX];
+static int16_t            ADC_EMG_Aligned_State[ADC_EMG_CHANNEL_NUM][2*ADC_EMG_ALIGNED_TAPS_MAX];
+/* Sampling rate the resamplers were prepared for, 0 if not prepared yet or the rate ratio is not supported */
+static uint32_t           ADC_EMG_Aligned_Rate = 0;
+/* Resampled samples of the latest processed block and whether they have been read */
+static int16_t            ADC_EMG_Aligned_DataBuf[ADC_EMG_CHANNEL_NUM][ADC_BLOCK_FRAME_MAX_NUM];
+static uint32_t           ADC_EMG_Aligned_Num[ADC_EMG_CHANNEL_NUM] = {0};
+static bool               ADC_EMG_Aligned_Ready[ADC_EMG_CHANNEL_NUM] = {(bool)FALSE};
+
+/* Spectrum analyzer shared by the EMG channels and the band edges, unit: Hz */
+static Spectrum_Analyzer  ADC_EMG_Spectrum;
+static const float32_t    ADC_EMG_Spectrum_Band_Edges[ADC_EMG_SPECTRUM_BAND_NUM + 1] = {20.0f, 50.0f, 100.0f, 200.0f, 450.0f};
+/* Window length in use and the sampling rate the analyzer was prepared for, 0 if not prepared yet */
+static uint16_t           ADC_EMG_Spectrum_Size = ADC_EMG_SPECTRUM_SIZE_DEFAULT;
+static uint32_t           ADC_EMG_Spectrum_Rate = 0;
+/* Filtered samples of every EMG channel collected for the next window */
+static float32_t          ADC_EMG_Spectrum_History[ADC_EMG_CHANNEL_NUM][SPECTRUM_FFT_SIZE_MAX];
+static uint16_t           ADC_EMG_Spectrum_Fill[ADC_EMG_CHANNEL_NUM] = {0};
+/* Features of the latest window of every EMG channel, the time of its last sample, and whether it has been read */
+static Spectrum_Features  ADC_EMG_Spectrum_Result[ADC_EMG_CHANNEL_NUM];
+static uint32_t           ADC_EMG_Spectrum_Timestamp[ADC_EMG_CHANNEL_NUM] = {0};
+static bool               ADC_EMG_Spectrum_Ready[ADC_EMG_CHANNEL_NUM] = {(bool)FALSE};
+
+/* Sample ring between the ADC interrupt (producer) and the main loop (consumer) */
+static Sample_Frame ADC_SampleRing_Buf[ADC_SAMPLE_RING_SIZE];
+static SampleRing   ADC_SampleRing = {ADC_SampleRing_Buf, ADC_SAMPLE_RING_SIZE, ADC_SAMPLE_RING_SIZE - 1, 0, 0, 0, 0};
+/* Index of the next frame pushed into the sample ring */
+static uint32_t     ADC_Sample_Index = 0;
+
 /* Static function definition-------------------------------------------------*/
 
+/* Take the oversampled data of one rank and convert the newest sample to mV */
+static t_FuncRet ADC_Oversampled_Update(uint8_t Rank);
+/* Design the coefficient set in use for a sampling rate and load it into every EMG cascade */
+static t_FuncRet ADC_EMG_Filter_Design(uint32_t Sample_Rate);
+/* Update the tone tracking of every EMG channel with a queued block */
+static void ADC_EMG_Tone_Process(const ADC_EMG_Block* p_Block, bool Gap);
+/* Update the linear envelope of every EMG channel with a queued block */
+static void ADC_EMG_Envelope_Process(const ADC_EMG_Block* p_Block);
+/* Resample every EMG channel of a queued block to ADC_EMG_ALIGNED_RATE_HZ */
+static void ADC_EMG_Aligned_Process(const ADC_EMG_Block* p_Block);
+
 /* Function definition--------------------------------------------------------*/
 
 /** 
-* @description: Get the Mean filter voltage value
+* @description: Set the window length of the moving average filter of every channel, the history is cleared
+* @param  {uint16_t} Window : Window length, 1 - MOVING_AVERAGE_WINDOW_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Set_ADC_MeanFilter_Window(uint16_t Window)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(!IS_MOVING_AVERAGE_WINDOW(Window))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	/* The filters may be updated in the TIM2 interrupt (software polling mode), the caller may already mask interrupts */
+	uint32_t PriMask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t ch = 0; ch < ADC_CHANNEL_ID_NUM; ch++)
+	{
+		Moving_Average_Init_U16(&Sensor_MeanFilter[ch], Window);
+	}
+	MeanFilterInitFlag = (bool)TRUE;
+	__set_PRIMASK(PriMask);
+	
+	return ret;
+}
+
+/** 
+* @description: Get the Mean filter voltage value: the newest sample of every channel goes through
+*				its moving average filter, one update costs the same for any window length
 * @param  {uint16_t*}  p_Sensor1_V_Data : Voltage after filtering
 * @param  {uint16_t*}  p_Sensor2_V_Data : Voltage after filtering
 * @param  {uint16_t*}  p_Sensor3_V_Data : Voltage after filtering
@@ -80,8 +248,18 @@ t_FuncRet Get_ADC_MeanFilter_Value(uint16_t* p_Sensor1_V_Data ,
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	/* Initializes the filter structure */
-	Mean_Filter_U16 FilterStruct = {0};
+	uint16_t*        p_Result[ADC_CHANNEL_ID_NUM] = {p_Sensor1_V_Data, p_Sensor2_V_Data, p_Sensor3_V_Data, p_Sensor4_V_Data, p_Vref_V_Data};
+	ADC_Channel_View View;
+	
+	/* The filters start with the default window */
+	if(MeanFilterInitFlag == (bool)FALSE)
+	{
+		for(uint8_t ch = 0; ch < ADC_CHANNEL_ID_NUM; ch++)
+		{
+			Moving_Average_Init_U16(&Sensor_MeanFilter[ch], MEAN_FILTER_NUM);
+		}
+		MeanFilterInitFlag = (bool)TRUE;
+	}
 	
 	/* Turn on ADC voltage acquisition once */
 	ret = ADC_Get_Data();
@@ -90,45 +268,23 @@ t_FuncRet Get_ADC_MeanFilter_Value(uint16_t* p_Sensor1_V_Data ,
 		return ret;
 	}
 	
-	/* Index Value Judgment */
-	if(DataBuf_Index >= (MEAN_FILTER_NUM-1))
-	{
-		DataBuf_Index = 0;
-	}
-	else
+	/* Voltage signals are collected synchronously by five channels, the newest sample is read in place */
+	for(uint8_t ch = 0; ch < ADC_CHANNEL_ID_NUM; ch++)
 	{
-		DataBuf_Index++;
+		ret = ADC_Get_Channel_View((ADC_Channel_ID)ch, &View);
+		if(ret != (t_FuncRet)Operation_Success)
+		{
+			return ret;
+		}
+		
+		/* An oversampled rank gives its newest oversampled sample instead, once the first one is complete */
+		if((ch < ADC_SCAN_RANK_NUM) && (ADC_Oversampled_Update(ch) == (t_FuncRet)Operation_Success))
+		{
+			*p_Result[ch] = Moving_Average_Update_U16(&Sensor_MeanFilter[ch], ADC_Oversampled_mVolt[ch]);
+			continue;
+		}
+		*p_Result[ch] = Moving_Average_Update_U16(&Sensor_MeanFilter[ch], View.p_Data[(View.Length - 1)*View.Stride]);
 	}
-	
-	/* Voltage signals are collected synchronously by five channels */
-	ADC_Get_SensorData_1(&Sensor_No1_DataBuf[DataBuf_Index]);
-	ADC_Get_SensorData_2(&Sensor_No2_DataBuf[DataBuf_Index]);
-	ADC_Get_SensorData_3(&Sensor_No3_DataBuf[DataBuf_Index]);
-	ADC_Get_SensorData_4(&Sensor_No4_DataBuf[DataBuf_Index]);
-	ADC_Get_Vref(&Sensor_Vref_DataBuf[DataBuf_Index]);
-
-	/* Mean filtering */
-	*p_Sensor1_V_Data = Data_Mean_Filter_U16((Mean_Filter_U16*)&FilterStruct ,(uint16_t*)Sensor_No1_DataBuf);
-	Mean_Filter_Rest_U16((Mean_Filter_U16*)&FilterStruct);
-	
-	*p_Sensor2_V_Data = Data_Mean_Filter_U16((Mean_Filter_U16*)&FilterStruct ,(uint16_t*)Sensor_No2_DataBuf);
-	Mean_Filter_Rest_U16((Mean_Filter_U16*)&FilterStruct);
-	
-	*p_Sensor3_V_Data = Data_Mean_Filter_U16((Mean_Filter_U16*)&FilterStruct ,(uint16_t*)Sensor_No3_DataBuf);
-	Mean_Filter_Rest_U16((Mean_Filter_U16*)&FilterStruct);
-	
-	*p_Sensor4_V_Data = Data_Mean_Filter_U16((Mean_Filter_U16*)&FilterStruct ,(uint16_t*)Sensor_No4_DataBuf);
-	Mean_Filter_Rest_U16((Mean_Filter_U16*)&FilterStruct);
-	
-	*p_Vref_V_Data    = Data_Mean_Filter_U16((Mean_Filter_U16*)&FilterStruct ,(uint16_t*)Sensor_Vref_DataBuf);
-	Mean_Filter_Rest_U16((Mean_Filter_U16*)&FilterStruct);
-	
-	/* Result back on the array */
-	Sensor_No1_DataBuf[DataBuf_Index]  = *p_Sensor1_V_Data;
-	Sensor_No2_DataBuf[DataBuf_Index]  = *p_Sensor2_V_Data;
-	Sensor_No3_DataBuf[DataBuf_Index]  = *p_Sensor3_V_Data;
-	Sensor_No4_DataBuf[DataBuf_Index]  = *p_Sensor4_V_Data;
-	Sensor_Vref_DataBuf[DataBuf_Index] = *p_Vref_V_Data;
 
 	return ret;
 }
@@ -151,44 +307,962 @@ t_FuncRet Get_ADC_KalmanFilter_Value(float* p_Sensor1_V_Data ,
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	uint16_t temp_Sensor1_V_Data = 0;
-    uint16_t temp_Sensor2_V_Data = 0;
-	uint16_t temp_Sensor3_V_Data = 0;
-	uint16_t temp_Sensor4_V_Data = 0;
-	uint16_t temp_Vref_V_Data    = 0;
+	uint16_t temp_V_Data[ADC_CHANNEL_ID_NUM] = {0};
+	float    Frame_In[ADC_CHANNEL_ID_NUM];
+	float    Frame_Out[ADC_CHANNEL_ID_NUM];
+	float*   p_Result[ADC_CHANNEL_ID_NUM] = {p_Sensor1_V_Data, p_Sensor2_V_Data, p_Sensor3_V_Data, p_Sensor4_V_Data, p_Vref_V_Data};
 	
 	/* First time set the Kalman filter parameters */
 	if(KalmanFilterInitFlag == (bool)FALSE)
 	{
-		KalmanFilter_Init((Kalman_Filter*)&KalmanFilterStruct_Sensor_No1);
-		KalmanFilter_Init((Kalman_Filter*)&KalmanFilterStruct_Sensor_No2);
-		KalmanFilter_Init((Kalman_Filter*)&KalmanFilterStruct_Sensor_No3);
-		KalmanFilter_Init((Kalman_Filter*)&KalmanFilterStruct_Sensor_No4);
-		KalmanFilter_Init((Kalman_Filter*)&KalmanFilterStruct_Sensor_Vref);
+		KalmanFilter_Bank_Init((Kalman_Filter_Bank*)&KalmanFilterBank_Sensor, ADC_CHANNEL_ID_NUM);
 		
 		KalmanFilterInitFlag = (bool)TRUE;
 	}
 
 	/* Get the median filter voltage value */
-	ret = Get_ADC_MeanFilter_Value((uint16_t*)&temp_Sensor1_V_Data , 
-								   (uint16_t*)&temp_Sensor2_V_Data ,
-						           (uint16_t*)&temp_Sensor3_V_Data ,
-						           (uint16_t*)&temp_Sensor4_V_Data ,
-						           (uint16_t*)&temp_Vref_V_Data);
+	ret = Get_ADC_MeanFilter_Value((uint16_t*)&temp_V_Data[ADC_CHANNEL_ID_SENSOR_1] , 
+								   (uint16_t*)&temp_V_Data[ADC_CHANNEL_ID_SENSOR_2] ,
+						           (uint16_t*)&temp_V_Data[ADC_CHANNEL_ID_SENSOR_3] ,
+						           (uint16_t*)&temp_V_Data[ADC_CHANNEL_ID_SENSOR_4] ,
+						           (uint16_t*)&temp_V_Data[ADC_CHANNEL_ID_VREF]);
 	if(ret != (t_FuncRet)Operation_Success)
 	{
 		return ret;
 	}
 	
-	/* The voltage data after Kalman filter is obtained */
-	*p_Sensor1_V_Data = ROUND_TO_UINT16(1000*KalmanFilter_Calculate((Kalman_Filter*)&KalmanFilterStruct_Sensor_No1 , (float)temp_Sensor1_V_Data/1000));
-	*p_Sensor2_V_Data = ROUND_TO_UINT16(1000*KalmanFilter_Calculate((Kalman_Filter*)&KalmanFilterStruct_Sensor_No2 , (float)temp_Sensor2_V_Data/1000));
-	*p_Sensor3_V_Data = ROUND_TO_UINT16(1000*KalmanFilter_Calculate((Kalman_Filter*)&KalmanFilterStruct_Sensor_No3 , (float)temp_Sensor3_V_Data/1000));
-	*p_Sensor4_V_Data = ROUND_TO_UINT16(1000*KalmanFilter_Calculate((Kalman_Filter*)&KalmanFilterStruct_Sensor_No4 , (float)temp_Sensor4_V_Data/1000));
-	*p_Vref_V_Data    = ROUND_TO_UINT16(1000*KalmanFilter_Calculate((Kalman_Filter*)&KalmanFilterStruct_Sensor_Vref, (float)temp_Vref_V_Data/1000));
+	/* The voltage data after Kalman filter is obtained, all channels of the frame in one call */
+	for(uint8_t ch = 0; ch < ADC_CHANNEL_ID_NUM; ch++)
+	{
+		Frame_In[ch] = (float)temp_V_Data[ch]/1000;
+	}
+	
+	KalmanFilter_Bank_Calculate((Kalman_Filter_Bank*)&KalmanFilterBank_Sensor, Frame_In, Frame_Out);
+	
+	for(uint8_t ch = 0; ch < ADC_CHANNEL_ID_NUM; ch++)
+	{
+		*p_Result[ch] = ROUND_TO_UINT16(1000*Frame_Out[ch]);
+	}
+
+	return ret;
+}
 
+/** 
+* @description: Filter one channel of the latest block by the Kalman filter, every sample of the block.
+*				The gain is set to its steady state value at the start, so the block is a fixed gain first order IIR
+*				without any division. The state goes on from the previous call, the filter bridges the blocks 
+*				converted between two calls as one step
+* @param  {ADC_Channel_ID} Channel   : Channel of the block, ADC_CHANNEL_ID_SENSOR_1 - ADC_CHANNEL_ID_VREF
+* @param  {float*}         p_DstBuff : Voltage after filtering, ADC_BLOCK_FRAME_MAX_NUM samples at most, unit: mV
+* @param  {uint32_t*}      p_Num     : Number of filtered samples
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no data converted yet
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_KalmanFilter_Block(ADC_Channel_ID Channel, float* p_DstBuff, uint32_t* p_Num)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	ADC_Channel_View View;
+	
+	if((uint32_t)Channel >= ADC_CHANNEL_ID_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	/* First time set the Kalman filter parameters and jump to the gain they converge to */
+	if(KalmanBlockInitFlag == (bool)FALSE)
+	{
+		KalmanFilter_Bank_Init(&KalmanFilterBank_Block, ADC_CHANNEL_ID_NUM);
+		KalmanFilter_Bank_Set_Steady(&KalmanFilterBank_Block);
+		
+		KalmanBlockInitFlag = (bool)TRUE;
+	}
+	
+	ret = ADC_Get_Channel_View(Channel, &View);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	
+	KalmanFilter_Bank_Process_U16(&KalmanFilterBank_Block, (uint32_t)Channel, View.p_Data, View.Stride, p_DstBuff, View.Length);
+	*p_Num = View.Length;
+	
 	return ret;
 }
  
 
+/** 
+* @description: A block of DMA frames is complete, called in the DMA interrupt.
+*				Overrides the weak definition in ADC_Operation.c
+* @param  {uint16_t*} p_Block   : Start address of the finished block
+* @param  {uint32_t}  Frame_Num : Number of frames in the block
+* @return {void} 
+* @author: leeqingshui 
+*/
+void ADC_BlockReady_Callback(uint16_t* p_Block, uint32_t Frame_Num)
+{
+	/* Oversampling and decimation run on the block boundary, partial sums carry to the next block */
+	for(uint8_t rank = 0; rank < ADC_SCAN_RANK_NUM; rank++)
+	{
+		/* Only the rings of the ranks with a ratio above 1 are taken by the main loop */
+		if(ADC_Oversampled_Used[rank] == (bool)FALSE)
+		{
+			continue;
+		}
+		
+		uint32_t Num  = ADC_Oversampling_Block(p_Block, Frame_Num, rank, ADC_Oversampled_Block);
+		uint32_t Head = ADC_Oversampled_Head[rank];
+		
+		for(uint32_t i = 0; i < Num; i++)
+		{
+			/* A full ring drops the sample and counts it as overrun */
+			if(((Head + 1) & (ADC_OVERSAMPLED_RING_SIZE - 1)) == ADC_Oversampled_Tail[rank])
+			{
+				ADC_Oversampled_Overrun[rank] = ADC_Oversampled_Overrun[rank] + (Num - i);
+				break;
+			}
+			ADC_Oversampled_Ring[rank][Head] = ADC_Oversampled_Block[i];
+			Head = (Head + 1) & (ADC_OVERSAMPLED_RING_SIZE - 1);
+		}
+		ADC_Oversampled_Head[rank] = Head;
+	}
+	
+#if(ADC_ACQUISITION_MODE == ADC_MODE_DMA_BLOCK)
+	/* Every calibrated frame of the block goes into the sample ring, the main loop sends them */
+	uint16_t*    p_Calibrated = NULL;
+	uint32_t     Calibrated_Num = 0;
+	Sample_Frame Frame;
+	
+	if(ADC_Get_CalibratedBlock(&p_Calibrated, &Calibrated_Num) == (t_FuncRet)Operation_Success)
+	{
+		/* Frames are converted one sampling period apart, the last one at the block timestamp */
+		uint32_t Sample_Rate  = ADC_Get_SampleRate();
+		uint32_t Period_Us    = 1000000 / Sample_Rate;
+		uint32_t Timestamp_Us = ADC_Get_BlockTimestamp() - (Calibrated_Num - 1)*Period_Us;
+		/* The EMG channels are copied for ADC_EMG_Block_Process, a full queue drops the block */
+		uint8_t        Next  = (uint8_t)((ADC_EMG_Block_Tail + 1) % (ADC_EMG_BLOCK_QUEUE_NUM + 1));
+		ADC_EMG_Block* p_EMG = (Next != ADC_EMG_Block_Head) ? &ADC_EMG_Block_Queue[ADC_EMG_Block_Tail] : NULL;
+		
+		if(p_EMG != NULL)
+		{
+			p_EMG->SampleIndex = ADC_Sample_Index;
+			p_EMG->Timestamp   = Timestamp_Us;
+			p_EMG->Sample_Rate = Sample_Rate;
+			p_EMG->Frame_Num   = Calibrated_Num;
+		}
+		
+		for(uint32_t i = 0; i < Calibrated_Num; i++)
+		{
+			if(p_EMG != NULL)
+			{
+				for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+				{
+					p_EMG->Data[ch][i] = p_Calibrated[ch];
+				}
+			}
+			
+			Frame.SampleIndex = ADC_Sample_Index++;
+			Frame.Timestamp   = Timestamp_Us;
+			Timestamp_Us      = Timestamp_Us + Period_Us;
+			Frame.Data[0]     = p_Calibrated[0];
+			Frame.Data[1]     = p_Calibrated[1];
+			Frame.Data[2]     = p_Calibrated[2];
+			Frame.Data[3]     = p_Calibrated[3];
+			Frame.Vref        = ADC_Get_VrefInt();
+			
+			/* A full ring drops the frame and counts it as overrun */
+			SampleRing_Push(&ADC_SampleRing, &Frame);
+			
+			p_Calibrated = p_Calibrated + ADC_SCAN_RANK_NUM;
+		}
+		
+		if(p_EMG != NULL)
+		{
+			ADC_EMG_Block_Tail = Next;
+		}
+	}
+	
+#endif
+	
+	p_ADC_Block         = p_Block;
+	ADC_Block_FrameNum  = Frame_Num;
+	ADC_BlockReady_Flag = (bool)TRUE;
+}
+
+/** 
+* @description: Obtain the latest block of DMA frames handed over by the ADC layer.
+*				Each frame holds ADC_SCAN_RANK_NUM interleaved ranks: CH1, CH3, CH5, CH6, 
+*				followed by Vref unless it is converted as an injected channel (ADC_VREF_INJECTED_USED).
+*				The block must be used up within one block time, after that DMA overwrites it
+* @param  {uint16_t**} pp_Block    : Start address of the block
+* @param  {uint32_t*}  p_Frame_Num : Number of frames in the block
+* @return {t_FuncRet } : Operation_Success if a new block is returned, Operation_Wait if no new block arrived
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_Block_Data(uint16_t** pp_Block, uint32_t* p_Frame_Num)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(ADC_BlockReady_Flag == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	ADC_BlockReady_Flag = (bool)FALSE;
+	
+	*pp_Block    = (uint16_t*)p_ADC_Block;
+	*p_Frame_Num = ADC_Block_FrameNum;
+	
+	return ret;
+}
+
+/** 
+* @description: Set the oversampling ratio of one channel, the oversampled data not read yet and the overrun count are cleared.
+*				Get_ADC_MeanFilter_Value uses the oversampled data of the channel while the ratio is above 1.
+*				Used in ADC_MODE_DMA_BLOCK, the oversampling runs on the DMA blocks
+* @param  {ADC_Channel_ID} Channel : Channel with a rank in the scan, ADC_CHANNEL_ID_SENSOR_1 - ADC_CHANNEL_ID_SENSOR_4 (and Vref if not injected)
+* @param  {uint16_t}       Ratio   : Oversampling ratio, a power of 2 in 1 ~ ADC_OVERSAMPLING_RATIO_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Set_ADC_Oversampling(ADC_Channel_ID Channel, uint16_t Ratio)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+#if(ADC_ACQUISITION_MODE == ADC_MODE_DMA_BLOCK)
+	if((uint32_t)Channel >= ADC_SCAN_RANK_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	ret = ADC_Set_Oversampling((uint8_t)Channel, Ratio);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	
+	/* The ring of the channel is cleared with the DMA interrupt held off, samples of the old ratio are dropped */
+	uint32_t PriMask = __get_PRIMASK();
+	__disable_irq();
+	ADC_Oversampled_Head[Channel]    = 0;
+	ADC_Oversampled_Tail[Channel]    = 0;
+	ADC_Oversampled_Overrun[Channel] = 0;
+	ADC_Oversampled_mVolt[Channel]   = 0;
+	ADC_Oversampled_Used[Channel]    = (Ratio > 1) ? (bool)TRUE : (bool)FALSE;
+	__set_PRIMASK(PriMask);
+#else
+	ret = (t_FuncRet)Operation_Fail;
+#endif
+	
+	return ret;
+}
+
+/** 
+* @description: Take the oversampled data of one rank out of its ring, oldest first, called in the main loop.
+*				The data are raw ADC codes with p_Bits effective bits (full scale RANGE_12BITS << (Bits - 12)).
+*				Only the ranks with a ratio above 1 are pushed into their rings, which Get_ADC_MeanFilter_Value takes
+* @param  {uint8_t}   Rank      : Rank in the scan, 0 ~ ADC_SCAN_RANK_NUM-1
+* @param  {uint16_t*} p_DstBuff : Oversampled data
+* @param  {uint32_t}  Max_Num   : Number of samples p_DstBuff can hold
+* @param  {uint32_t*} p_Num     : Number of samples taken
+* @param  {uint8_t*}  p_Bits    : Effective resolution of the data, unit: bits
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if the ring is empty
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_Oversampled_Data(uint8_t Rank, uint16_t* p_DstBuff, uint32_t Max_Num, uint32_t* p_Num, uint8_t* p_Bits)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	uint32_t Tail = 0;
+	uint32_t Head = 0;
+	uint32_t Num  = 0;
+	
+	if(Rank >= ADC_SCAN_RANK_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	Tail = ADC_Oversampled_Tail[Rank];
+	Head = ADC_Oversampled_Head[Rank];
+	
+	while((Tail != Head) && (Num < Max_Num))
+	{
+		p_DstBuff[Num++] = ADC_Oversampled_Ring[Rank][Tail];
+		Tail = (Tail + 1) & (ADC_OVERSAMPLED_RING_SIZE - 1);
+	}
+	ADC_Oversampled_Tail[Rank] = Tail;
+	
+	*p_Num  = Num;
+	*p_Bits = ADC_Get_Oversampling_Bits(Rank);
+	
+	if(Num == 0)
+	{
+		ret = (t_FuncRet)Operation_Wait;
+	}
+	
+	return ret;
+}
+
+/** 
+* @description: Return the number of oversampled samples of one rank dropped because its ring was full
+* @param  {uint8_t} Rank : Rank in the scan, 0 ~ ADC_SCAN_RANK_NUM-1
+* @return {uint32_t}     : Number of dropped samples
+* @author: leeqingshui 
+*/
+uint32_t Get_ADC_Oversampled_Overrun(uint8_t Rank)
+{
+	if(Rank >= ADC_SCAN_RANK_NUM)
+	{
+		return 0;
+	}
+	
+	return ADC_Oversampled_Overrun[Rank];
+}
+
+/** 
+* @description: Acquire one mean filtered frame and push it into the sample ring.
+*				Used in ADC_MODE_SOFTWARE_POLLING, called in the TIM2 interrupt
+* @param  {void} 
+* @return {t_FuncRet } : if success,return Operation_Success, Operation_Fail if the ring is full
+* @author: leeqingshui 
+*/
+t_FuncRet Push_ADC_MeanFilter_Frame(void)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	Sample_Frame Frame;
+	
+	ret = Get_ADC_MeanFilter_Value(&Frame.Data[0], &Frame.Data[1], &Frame.Data[2], &Frame.Data[3], &Frame.Vref);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	
+	Frame.SampleIndex = ADC_Sample_Index++;
+	Frame.Timestamp   = GET_TIMESTAMP_US();
+	
+	return SampleRing_Push(&ADC_SampleRing, &Frame);
+}
+
+/** 
+* @description: Take the oldest frame out of the sample ring, called in the main loop
+* @param  {Sample_Frame*} p_Frame : The oldest frame
+* @return {t_FuncRet } : if success,return Operation_Success, Operation_Wait if the ring is empty
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_Frame(Sample_Frame* p_Frame)
+{
+	return SampleRing_Pop(&ADC_SampleRing, p_Frame);
+}
+
+/** 
+* @description: Obtain the state of the sample ring
+* @param  {uint32_t*} p_Count      : Number of frames waiting to be sent
+* @param  {uint32_t*} p_Overrun    : Number of frames dropped because the ring was full
+* @param  {uint32_t*} p_High_Water : Largest number of frames ever waiting in the ring
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_SampleRing_State(uint32_t* p_Count, uint32_t* p_Overrun, uint32_t* p_High_Water)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	*p_Count      = SampleRing_Get_Count(&ADC_SampleRing);
+	*p_Overrun    = SampleRing_Get_Overrun(&ADC_SampleRing);
+	*p_High_Water = ADC_SampleRing.High_Water;
+	
+	return ret;
+}
+
+/** 
+* @description: Select the coefficient set of the EMG biquad cascades, the cascades are designed
+*				for the current sampling rate and their state is cleared
+* @param  {ADC_EMG_Filter_ID} Filter_ID : Coefficient set
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Set_ADC_EMG_Filter(ADC_EMG_Filter_ID Filter_ID)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((uint32_t)Filter_ID >= (uint32_t)ADC_EMG_FILTER_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	ADC_EMG_Filter_ID_Used = Filter_ID;
+	
+	return ADC_EMG_Filter_Design(ADC_Get_SampleRate());
+}
+
+/** 
+* @description: Obtain one EMG channel of the latest block processed by ADC_EMG_Block_Process, filtered by its biquad cascade.
+*				The samples of a block are returned once, a block not read before the next one is processed is lost
+* @param  {ADC_Channel_ID} Channel   : EMG channel, ADC_CHANNEL_ID_SENSOR_1 - ADC_CHANNEL_ID_SENSOR_4
+* @param  {float32_t*}     p_DstBuff : Filtered voltage, ADC_BLOCK_FRAME_MAX_NUM samples at most, unit: mV
+* @param  {uint32_t*}      p_Num     : Number of filtered samples
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no new block was processed
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_EMG_Filtered_Block(ADC_Channel_ID Channel, float32_t* p_DstBuff, uint32_t* p_Num)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((uint32_t)Channel >= ADC_EMG_CHANNEL_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	if(ADC_EMG_Filtered_Ready[Channel] == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	/* Written and read in the main loop, no lock is needed */
+	*p_Num = ADC_EMG_Filtered_Num;
+	memcpy(p_DstBuff, ADC_EMG_Filtered_DataBuf[Channel], ADC_EMG_Filtered_Num*sizeof(float32_t));
+	ADC_EMG_Filtered_Ready[Channel] = (bool)FALSE;
+	
+	return ret;
+}
+
+/** 
+* @description: Return the cycles per sample spent by the last EMG biquad cascade call (DWT cycle counter)
+* @param  {void} 
+* @return {uint32_t} : Core clock cycles per sample
+* @author: leeqingshui 
+*/
+uint32_t Get_ADC_EMG_Filter_Cycles(void)
+{
+	return ADC_EMG_Filter_Cycles;
+}
+
+/** 
+* @description: Obtain the amplitude of the tracked tones of one EMG channel (ADC_EMG_TONE_NUM values),
+*				updated by ADC_EMG_Block_Process over the last 1/ADC_EMG_TONE_RESOLUTION_HZ second
+* @param  {ADC_Channel_ID} Channel     : EMG channel, ADC_CHANNEL_ID_SENSOR_1 - ADC_CHANNEL_ID_SENSOR_4
+* @param  {float32_t*}     p_Magnitude : Amplitude of 50Hz, 60Hz, 100Hz and 250Hz, unit: mV
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no block was tracked yet
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_EMG_Tone_Magnitude(ADC_Channel_ID Channel, float32_t* p_Magnitude)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((uint32_t)Channel >= ADC_EMG_CHANNEL_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	if(ADC_EMG_Tone_Rate == 0)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	/* The banks are updated in the main loop, no lock is needed */
+	Sliding_DFT_Bank_Get_Magnitude(&ADC_EMG_Tone_Bank[Channel], p_Magnitude);
+	for(uint8_t b = 0; b < ADC_EMG_TONE_NUM; b++)
+	{
+		p_Magnitude[b] = p_Magnitude[b]*ADC_EMG_Tone_Gain[b];
+	}
+	
+	return ret;
+}
+
+/** 
+* @description: Obtain the linear envelope of one EMG channel computed from the latest block processed by ADC_EMG_Block_Process:
+*				baseline removed, rectified, low passed at ADC_EMG_ENVELOPE_CUTOFF_HZ, ADC_EMG_ENVELOPE_RATE_HZ samples per second.
+*				The samples of a block are returned once, a block not read before the next one is processed is lost
+* @param  {ADC_Channel_ID} Channel   : EMG channel, ADC_CHANNEL_ID_SENSOR_1 - ADC_CHANNEL_ID_SENSOR_4
+* @param  {float32_t*}     p_DstBuff : Envelope, ADC_BLOCK_FRAME_MAX_NUM samples at most, unit: mV
+* @param  {uint32_t*}      p_Num     : Number of envelope samples, may be 0 when a block is shorter than the decimation
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no new block was processed
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_EMG_Envelope(ADC_Channel_ID Channel, float32_t* p_DstBuff, uint32_t* p_Num)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((uint32_t)Channel >= ADC_EMG_CHANNEL_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	if(ADC_EMG_Envelope_Ready[Channel] == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	/* Written and read in the main loop, no lock is needed */
+	*p_Num = ADC_EMG_Envelope_Num[Channel];
+	memcpy(p_DstBuff, ADC_EMG_Envelope_DataBuf[Channel], ADC_EMG_Envelope_Num[Channel]*sizeof(float32_t));
+	ADC_EMG_Envelope_Ready[Channel] = (bool)FALSE;
+	
+	return ret;
+}
+
+/** 
+* @description: Obtain one EMG channel of the latest block processed by ADC_EMG_Block_Process, resampled to 
+*				ADC_EMG_ALIGNED_RATE_HZ (polyphase FIR, Q15).
+*				The samples of a block are returned once, a block not read before the next one is processed is lost
+* @param  {ADC_Channel_ID} Channel   : EMG channel, ADC_CHANNEL_ID_SENSOR_1 - ADC_CHANNEL_ID_SENSOR_4
+* @param  {int16_t*}       p_DstBuff : Resampled voltage, ADC_BLOCK_FRAME_MAX_NUM samples at most, unit: mV
+* @param  {uint32_t*}      p_Num     : Number of resampled samples
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no new block was processed
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_EMG_Aligned(ADC_Channel_ID Channel, int16_t* p_DstBuff, uint32_t* p_Num)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((uint32_t)Channel >= ADC_EMG_CHANNEL_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	if(ADC_EMG_Aligned_Ready[Channel] == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	/* Written and read in the main loop, no lock is needed */
+	*p_Num = ADC_EMG_Aligned_Num[Channel];
+	memcpy(p_DstBuff, ADC_EMG_Aligned_DataBuf[Channel], ADC_EMG_Aligned_Num[Channel]*sizeof(int16_t));
+	ADC_EMG_Aligned_Ready[Channel] = (bool)FALSE;
+	
+	return ret;
+}
+
+/** 
+* @description: Set the window length of the EMG spectral analysis, the collected samples are dropped
+* @param  {uint16_t} FFT_Size : Window length, 256 / 512 / 1024 samples
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Set_ADC_EMG_Spectrum_Size(uint16_t FFT_Size)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(!IS_SPECTRUM_FFT_SIZE(FFT_Size))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	ADC_EMG_Spectrum_Size = FFT_Size;
+	/* The analyzer is prepared again by the next ADC_EMG_Block_Process */
+	ADC_EMG_Spectrum_Rate = 0;
+	
+	return ret;
+}
+
+/** 
+* @description: Take the oldest EMG block queued in the DMA interrupt, filter every channel by its biquad cascade 
+*				and collect the samples. Every time a channel has collected a whole window its spectral features are computed,
+*				the second half of the window is kept as the first half of the next one (50% overlap).
+*				A block that does not follow the previous one (dropped by a full queue) starts the windows again.
+*				The tones, the linear envelope and the resampled copy of every channel are updated with the same block.
+*				The cascades and the analyzer are prepared again when the sampling rate of the blocks has changed.
+*				Called in the main loop, one block per call
+* @param  {void} 
+* @return {t_FuncRet } : Operation_Success if a block was processed, Operation_Wait if no block is queued
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_EMG_Block_Process(void)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	ADC_EMG_Block* p_Block   = NULL;
+	bool           Gap       = (bool)FALSE;
+	uint32_t       Period_Us = 0;
+	uint32_t       Cycles    = 0;
+	uint16_t       Half      = ADC_EMG_Spectrum_Size/2;
+	
+	if(ADC_EMG_Block_Head == ADC_EMG_Block_Tail)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	p_Block = &ADC_EMG_Block_Queue[ADC_EMG_Block_Head];
+	
+	/* A block that does not follow the previous one comes after frames lost by a full queue */
+	Gap = (p_Block->SampleIndex != ADC_EMG_Block_Next_Index) ? (bool)TRUE : (bool)FALSE;
+	ADC_EMG_Block_Next_Index = p_Block->SampleIndex + p_Block->Frame_Num;
+	
+	if(ADC_EMG_Filter_Rate != p_Block->Sample_Rate)
+	{
+		ret = ADC_EMG_Filter_Design(p_Block->Sample_Rate);
+	}
+	
+	/* A new sampling profile or window length: prepare the analyzer and start the windows again */
+	if((ret == (t_FuncRet)Operation_Success) && (ADC_EMG_Spectrum_Rate != p_Block->Sample_Rate))
+	{
+		ret = Spectrum_Init(&ADC_EMG_Spectrum, ADC_EMG_Spectrum_Size, (float32_t)p_Block->Sample_Rate);
+		if(ret == (t_FuncRet)Operation_Success)
+		{
+			memset(ADC_EMG_Spectrum_Fill, 0, sizeof(ADC_EMG_Spectrum_Fill));
+			ADC_EMG_Spectrum_Rate = p_Block->Sample_Rate;
+		}
+	}
+	
+	if(ret == (t_FuncRet)Operation_Success)
+	{
+		/* No window may span the frames lost before this block */
+		if(Gap == (bool)TRUE)
+		{
+			memset(ADC_EMG_Spectrum_Fill, 0, sizeof(ADC_EMG_Spectrum_Fill));
+		}
+		
+		Period_Us            = 1000000 / p_Block->Sample_Rate;
+		ADC_EMG_Filtered_Num = p_Block->Frame_Num;
+		
+		for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+		{
+			float32_t* p_Filtered = ADC_EMG_Filtered_DataBuf[ch];
+			
+			for(uint32_t i = 0; i < p_Block->Frame_Num; i++)
+			{
+				p_Filtered[i] = (float32_t)p_Block->Data[ch][i];
+			}
+			
+			if(ADC_EMG_Filter_ID_Used != ADC_EMG_FILTER_NONE)
+			{
+				Cycles = GET_CYCLE_COUNT();
+				Biquad_Cascade_Process_F(&ADC_EMG_Filter[ch], p_Filtered, p_Filtered, p_Block->Frame_Num);
+				Cycles = GET_CYCLE_COUNT() - Cycles;
+				
+				ADC_EMG_Filter_Cycles = Cycles / p_Block->Frame_Num;
+			}
+			ADC_EMG_Filtered_Ready[ch] = (bool)TRUE;
+			
+			for(uint32_t i = 0; i < p_Block->Frame_Num; i++)
+			{
+				ADC_EMG_Spectrum_History[ch][ADC_EMG_Spectrum_Fill[ch]++] = p_Filtered[i];
+				
+				if(ADC_EMG_Spectrum_Fill[ch] == ADC_EMG_Spectrum_Size)
+				{
+					Spectrum_Get_Features(&ADC_EMG_Spectrum, ADC_EMG_Spectrum_History[ch], ADC_EMG_Spectrum_Band_Edges,
+										  ADC_EMG_SPECTRUM_BAND_NUM, &ADC_EMG_Spectrum_Result[ch]);
+					
+					ADC_EMG_Spectrum_Timestamp[ch] = p_Block->Timestamp + i*Period_Us;
+					ADC_EMG_Spectrum_Ready[ch]     = (bool)TRUE;
+					
+					memmove(ADC_EMG_Spectrum_History[ch], &ADC_EMG_Spectrum_History[ch][Half], Half*sizeof(float32_t));
+					ADC_EMG_Spectrum_Fill[ch] = Half;
+				}
+			}
+		}
+	}
+	
+	/* The tones are tracked on the unfiltered block, the mains tones are removed by the notch */
+	ADC_EMG_Tone_Process(p_Block, Gap);
+	/* Rectification, low pass and decimation in one pass over the unfiltered block, the state carries to the next block */
+	ADC_EMG_Envelope_Process(p_Block);
+	/* The same block brought to the rate shared with the motion data */
+	ADC_EMG_Aligned_Process(p_Block);
+	
+	/* The slot is given back even if the block could not be filtered */
+	ADC_EMG_Block_Head = (uint8_t)((ADC_EMG_Block_Head + 1) % (ADC_EMG_BLOCK_QUEUE_NUM + 1));
+	
+	return ret;
+}
+
+/** 
+* @description: Obtain the spectral features of the latest window of one EMG channel
+* @param  {ADC_Channel_ID}     Channel     : EMG channel, ADC_CHANNEL_ID_SENSOR_1 - ADC_CHANNEL_ID_SENSOR_4
+* @param  {Spectrum_Features*} p_Features  : Mean / median frequency and band powers, unit: Hz and mV^2
+* @param  {uint32_t*}          p_Timestamp : Acquisition time of the last sample of the window, unit: us
+* @return {t_FuncRet } : Operation_Success if a new window was analyzed since the last call, Operation_Wait if not
+* @author: leeqingshui 
+*/
+t_FuncRet Get_ADC_EMG_Spectrum_Features(ADC_Channel_ID Channel, Spectrum_Features* p_Features, uint32_t* p_Timestamp)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((uint32_t)Channel >= ADC_EMG_CHANNEL_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	if(ADC_EMG_Spectrum_Ready[Channel] == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	ADC_EMG_Spectrum_Ready[Channel] = (bool)FALSE;
+	
+	*p_Features  = ADC_EMG_Spectrum_Result[Channel];
+	*p_Timestamp = ADC_EMG_Spectrum_Timestamp[Channel];
+	
+	return ret;
+}
+
+/** 
+* @description: Take the oversampled data of one rank out of its ring and convert the newest sample to mV,
+*				the scale of the latest calibrated block is used
+* @param  {uint8_t} Rank : Rank in the scan, 0 ~ ADC_SCAN_RANK_NUM-1
+* @return {t_FuncRet } : Operation_Success if the rank is oversampled and has a sample, Operation_Wait if not
+* @author: leeqingshui 
+*/
+static t_FuncRet ADC_Oversampled_Update(uint8_t Rank)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	uint16_t Data[32];
+	uint32_t Num  = 0;
+	uint8_t  Bits = 12;
+	
+	if(ADC_Oversampled_Used[Rank] == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	while(Get_ADC_Oversampled_Data(Rank, Data, sizeof(Data)/sizeof(Data[0]), &Num, &Bits) == (t_FuncRet)Operation_Success)
+	{
+		uint32_t Full_Scale = RANGE_12BITS << (Bits - 12);
+		
+		ADC_Oversampled_mVolt[Rank] = (uint16_t)(((uint32_t)Data[Num - 1]*ADC_Get_VDDA() + Full_Scale/2)/Full_Scale);
+	}
+	
+	if(ADC_Oversampled_mVolt[Rank] == 0)
+	{
+		ret = (t_FuncRet)Operation_Wait;
+	}
+	
+	return ret;
+}
 
+/** 
+* @description: Design the coefficient set in use for a sampling rate and load it into every EMG cascade.
+*				Band-pass: two high pass and two low pass Butterworth stages, the notch adds one stage
+* @param  {uint32_t} Sample_Rate : Sampling rate of the EMG blocks, unit: Hz
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+static t_FuncRet ADC_EMG_Filter_Design(uint32_t Sample_Rate)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	float32_t Coeffs[BIQUAD_COEFF_NUM*BIQUAD_STAGE_MAX];
+	uint8_t   Stage_Num   = 0;
+	
+	if(ADC_EMG_Filter_ID_Used == ADC_EMG_FILTER_NONE)
+	{
+		ADC_EMG_Filter_Rate = Sample_Rate;
+		return ret;
+	}
+	
+	ret = Biquad_Design(BIQUAD_HIGHPASS, (float32_t)Sample_Rate, ADC_EMG_BANDPASS_LOW_HZ,  BUTTERWORTH_4TH_Q1, &Coeffs[BIQUAD_COEFF_NUM*Stage_Num++]);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	ret = Biquad_Design(BIQUAD_HIGHPASS, (float32_t)Sample_Rate, ADC_EMG_BANDPASS_LOW_HZ,  BUTTERWORTH_4TH_Q2, &Coeffs[BIQUAD_COEFF_NUM*Stage_Num++]);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	ret = Biquad_Design(BIQUAD_LOWPASS,  (float32_t)Sample_Rate, ADC_EMG_BANDPASS_HIGH_HZ, BUTTERWORTH_4TH_Q1, &Coeffs[BIQUAD_COEFF_NUM*Stage_Num++]);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	ret = Biquad_Design(BIQUAD_LOWPASS,  (float32_t)Sample_Rate, ADC_EMG_BANDPASS_HIGH_HZ, BUTTERWORTH_4TH_Q2, &Coeffs[BIQUAD_COEFF_NUM*Stage_Num++]);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	
+	if(ADC_EMG_Filter_ID_Used != ADC_EMG_FILTER_BANDPASS)
+	{
+		float32_t Notch_Hz = (ADC_EMG_Filter_ID_Used == ADC_EMG_FILTER_BANDPASS_NOTCH50) ? 50.0f : 60.0f;
+		
+		ret = Biquad_Design(BIQUAD_NOTCH, (float32_t)Sample_Rate, Notch_Hz, ADC_EMG_NOTCH_Q, &Coeffs[BIQUAD_COEFF_NUM*Stage_Num++]);
+		if(ret != (t_FuncRet)Operation_Success)
+		{
+			return ret;
+		}
+	}
+	
+	for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+	{
+		Biquad_Cascade_Init_F(&ADC_EMG_Filter[ch], Coeffs, Stage_Num);
+	}
+	ADC_EMG_Filter_Rate = Sample_Rate;
+	
+	return ret;
+}
+
+/** 
+* @description: Update the tone tracking of every EMG channel with a queued block, called by ADC_EMG_Block_Process.
+*				Every channel is averaged down to ADC_EMG_TONE_RATE_HZ (or the sampling rate if slower) before its bank,
+*				the partial averages carry to the next block. The banks are prepared again when the sampling rate 
+*				has changed or frames were lost before the block
+* @param  {ADC_EMG_Block*} p_Block : Queued block
+* @param  {bool}           Gap     : TRUE if the block does not follow the previous one
+* @return {void} 
+* @author: leeqingshui 
+*/
+static void ADC_EMG_Tone_Process(const ADC_EMG_Block* p_Block, bool Gap)
+{
+	uint32_t Sample_Rate = p_Block->Sample_Rate;
+	uint32_t Decimation  = 0;
+	uint32_t Count       = 0;
+	
+	if((ADC_EMG_Tone_Rate != Sample_Rate) || (Gap == (bool)TRUE))
+	{
+		float32_t Rate   = 0;
+		uint32_t  Window = 0;
+		
+		Decimation = (Sample_Rate + ADC_EMG_TONE_RATE_HZ - 1) / ADC_EMG_TONE_RATE_HZ;
+		Rate       = (float32_t)Sample_Rate / Decimation;
+		Window     = (uint32_t)(Rate / ADC_EMG_TONE_RESOLUTION_HZ + 0.5f);
+		
+		ADC_EMG_Tone_Rate = 0;
+		for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+		{
+			if(Sliding_DFT_Bank_Init(&ADC_EMG_Tone_Bank[ch], (uint16_t)Window, Rate, 
+									 ADC_EMG_Tone_Freq, ADC_EMG_TONE_NUM) != (t_FuncRet)Operation_Success)
+			{
+				return;
+			}
+			ADC_EMG_Tone_Sum[ch] = 0;
+		}
+		
+		/* The average of Decimation samples passes a tone f with the gain sin(pi*f*D/Fs) / (D*sin(pi*f/Fs)) */
+		for(uint8_t b = 0; b < ADC_EMG_TONE_NUM; b++)
+		{
+			float32_t x = ADC_EMG_PI*ADC_EMG_Tone_Freq[b]/Sample_Rate;
+			
+			ADC_EMG_Tone_Gain[b] = (Decimation > 1) ? (Decimation*sinf(x)/sinf(Decimation*x)) : 1.0f;
+		}
+		
+		ADC_EMG_Tone_Decimation = Decimation;
+		ADC_EMG_Tone_Count      = 0;
+		ADC_EMG_Tone_Rate       = Sample_Rate;
+	}
+	
+	Decimation = ADC_EMG_Tone_Decimation;
+	
+	for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+	{
+		uint32_t Sum = ADC_EMG_Tone_Sum[ch];
+		uint32_t Num = 0;
+		
+		Count = ADC_EMG_Tone_Count;
+		for(uint32_t i = 0; i < p_Block->Frame_Num; i++)
+		{
+			Sum = Sum + p_Block->Data[ch][i];
+			
+			Count++;
+			if(Count == Decimation)
+			{
+				ADC_EMG_Tone_Block[Num++] = (float32_t)Sum / Decimation;
+				Sum   = 0;
+				Count = 0;
+			}
+		}
+		ADC_EMG_Tone_Sum[ch] = Sum;
+		
+		Sliding_DFT_Bank_Process(&ADC_EMG_Tone_Bank[ch], ADC_EMG_Tone_Block, Num);
+	}
+	ADC_EMG_Tone_Count = Count;
+}
+
+/** 
+* @description: Update the linear envelope of every EMG channel with a queued block, called by ADC_EMG_Block_Process.
+*				The filters are prepared again when the sampling rate has changed
+* @param  {ADC_EMG_Block*} p_Block : Queued block
+* @return {void} 
+* @author: leeqingshui 
+*/
+static void ADC_EMG_Envelope_Process(const ADC_EMG_Block* p_Block)
+{
+	uint32_t Sample_Rate = p_Block->Sample_Rate;
+	
+	if(ADC_EMG_Envelope_Rate != Sample_Rate)
+	{
+		uint32_t Decimation = (Sample_Rate + ADC_EMG_ENVELOPE_RATE_HZ/2) / ADC_EMG_ENVELOPE_RATE_HZ;
+		
+		if(Decimation == 0)
+		{
+			Decimation = 1;
+		}
+		
+		for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+		{
+			if(Envelope_Filter_Init(&ADC_EMG_Envelope_Filter[ch], (float32_t)Sample_Rate, ADC_EMG_ENVELOPE_CUTOFF_HZ,
+									ADC_EMG_ENVELOPE_BASELINE_HZ, (uint16_t)Decimation) != (t_FuncRet)Operation_Success)
+			{
+				ADC_EMG_Envelope_Rate = 0;
+				return;
+			}
+		}
+		ADC_EMG_Envelope_Rate = Sample_Rate;
+	}
+	
+	for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+	{
+		ADC_EMG_Envelope_Num[ch]   = Envelope_Filter_Process_U16(&ADC_EMG_Envelope_Filter[ch], p_Block->Data[ch], 1, 
+																 p_Block->Frame_Num, ADC_EMG_Envelope_DataBuf[ch]);
+		ADC_EMG_Envelope_Ready[ch] = (bool)TRUE;
+	}
+}
+
+/** 
+* @description: Resample every EMG channel of a queued block to ADC_EMG_ALIGNED_RATE_HZ, called by ADC_EMG_Block_Process.
+*				The rate ratio is reduced to Interpolation/Decimation, the resamplers are prepared again when the 
+*				sampling rate has changed. Only down sampling is done, a slower ADC leaves the data unaligned
+* @param  {ADC_EMG_Block*} p_Block : Queued block
+* @return {void} 
+* @author: leeqingshui 
+*/
+static void ADC_EMG_Aligned_Process(const ADC_EMG_Block* p_Block)
+{
+	uint32_t Sample_Rate = p_Block->Sample_Rate;
+	
+	if(ADC_EMG_Aligned_Rate != Sample_Rate)
+	{
+		uint32_t a = Sample_Rate, b = ADC_EMG_ALIGNED_RATE_HZ, Divisor;
+		uint32_t Interpolation, Decimation, Phase_Taps;
+		
+		while(b != 0)
+		{
+			Divisor = a % b;
+			a       = b;
+			b       = Divisor;
+		}
+		Interpolation = ADC_EMG_ALIGNED_RATE_HZ / a;
+		Decimation    = Sample_Rate / a;
+		
+		/* An unsupported ratio is found again on every block, it costs only the division above */
+		ADC_EMG_Aligned_Rate = 0;
+		if((Interpolation > Decimation) || !IS_POLYPHASE_FACTOR(Decimation))
+		{
+			return;
+		}
+		
+		/* About 8 taps per decimation step, limited by the coefficient table */
+		Phase_Taps = (8*Decimation < ADC_EMG_ALIGNED_TAPS_MAX) ? 8*Decimation : ADC_EMG_ALIGNED_TAPS_MAX;
+		Phase_Taps = Phase_Taps / Interpolation;
+		
+		if(Polyphase_FIR_Design_Q15((uint8_t)Interpolation, (uint8_t)Decimation, (uint16_t)Phase_Taps, 
+									ADC_EMG_Aligned_Coeffs) != (t_FuncRet)Operation_Success)
+		{
+			return;
+		}
+		for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+		{
+			Polyphase_FIR_Init_Q15(&ADC_EMG_Aligned_Resampler[ch], (uint8_t)Interpolation, (uint8_t)Decimation, (uint16_t)Phase_Taps, 
+								   ADC_EMG_Aligned_Coeffs, ADC_EMG_Aligned_State[ch]);
+		}
+		ADC_EMG_Aligned_Rate = Sample_Rate;
+	}
+	
+	for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+	{
+		/* The blocks hold mV below 3300, they are read as Q15 without conversion */
+		ADC_EMG_Aligned_Num[ch]   = Polyphase_FIR_Process_Q15(&ADC_EMG_Aligned_Resampler[ch], (const int16_t*)p_Block->Data[ch], 
+															  1, p_Block->Frame_Num, ADC_EMG_Aligned_DataBuf[ch]);
+		ADC_EMG_Aligned_Ready[ch] = (bool)TRUE;
+	}
+}
@@ -15,16 +15,94 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "ADC_Operation.h"
+#include "SampleRing_Buffer.h"
+#include "DigtalSignal_Process.h"
 
 /* Common macro definitions---------------------------------------------------*/
 
+/* Number of frames in the sample ring (a power of 2): 256 ms of data at 2000Hz, 51 ms at 10000Hz */
+#define ADC_SAMPLE_RING_SIZE            512
+
+/* Number of oversampled samples kept for the main loop in every rank (a power of 2) */
+#define ADC_OVERSAMPLED_RING_SIZE       256
+
+/* EMG band-pass edges, unit: Hz */
+#define ADC_EMG_BANDPASS_LOW_HZ         20.0f
+#define ADC_EMG_BANDPASS_HIGH_HZ        450.0f
+/* Quality factor of the mains notch: -3dB width of about 5Hz at 50Hz */
+#define ADC_EMG_NOTCH_Q                 10.0f
+/* Number of EMG channels filtered by the biquad cascades: sensor 1 - 4 */
+#define ADC_EMG_CHANNEL_NUM             4
+
+/* Number of EMG blocks the DMA interrupt can queue for the main loop (ADC_EMG_Block_Process) */
+#define ADC_EMG_BLOCK_QUEUE_NUM         4
+
+/* Default window length of the EMG spectral analysis, 256 / 512 / 1024 samples, the windows overlap by 50% */
+#define ADC_EMG_SPECTRUM_SIZE_DEFAULT   512
+/* Number of EMG spectral bands: 20 - 50Hz, 50 - 100Hz, 100 - 200Hz, 200 - 450Hz */
+#define ADC_EMG_SPECTRUM_BAND_NUM       4
+
+/* Number of tones tracked every sample on every EMG channel: 50Hz, 60Hz (mains), 100Hz, 250Hz (EMG) */
+#define ADC_EMG_TONE_NUM                4
+/* Bin spacing of the tone tracking, unit: Hz */
+#define ADC_EMG_TONE_RESOLUTION_HZ      5
+/* 
+    Rate the tone tracking runs at, unit: Hz. Faster channels are averaged over blocks of Sample_Rate/ADC_EMG_TONE_RATE_HZ 
+    samples (rounded up) before the sliding DFT, so a window of SLIDING_DFT_WINDOW_MAX keeps ADC_EMG_TONE_RESOLUTION_HZ bins
+*/
+#define ADC_EMG_TONE_RATE_HZ            (SLIDING_DFT_WINDOW_MAX*ADC_EMG_TONE_RESOLUTION_HZ)
+
+/* Output rate of the EMG linear envelope, the input is decimated by Sample_Rate/ADC_EMG_ENVELOPE_RATE_HZ, unit: Hz */
+#define ADC_EMG_ENVELOPE_RATE_HZ        100
+/* Low pass cutoff of the rectified EMG, below half of ADC_EMG_ENVELOPE_RATE_HZ, unit: Hz */
+#define ADC_EMG_ENVELOPE_CUTOFF_HZ      6.0f
+/* Corner of the baseline (electrode and bias offset) removed before rectification, unit: Hz */
+#define ADC_EMG_ENVELOPE_BASELINE_HZ    1.0f
+
+/* Common rate the EMG channels are resampled to for joint processing with the motion data, unit: Hz */
+#define ADC_EMG_ALIGNED_RATE_HZ         500
+/* Longest prototype of the EMG resampler low pass, about 8 taps per decimation step are used up to this length */
+#define ADC_EMG_ALIGNED_TAPS_MAX        128
+
 /* Data structure declaration-------------------------------------------------*/
 
+/* Coefficient set of the EMG biquad cascades */
+typedef enum
+{
+	/* No filtering, the calibrated voltage is copied */
+	ADC_EMG_FILTER_NONE             = 0,
+	/* 4th order Butterworth band-pass 20 - 450Hz */
+	ADC_EMG_FILTER_BANDPASS         = 1,
+	/* Band-pass and 50Hz notch */
+	ADC_EMG_FILTER_BANDPASS_NOTCH50 = 2,
+	/* Band-pass and 60Hz notch */
+	ADC_EMG_FILTER_BANDPASS_NOTCH60 = 3,
+	ADC_EMG_FILTER_NUM
+}ADC_EMG_Filter_ID;
+
+/* The EMG channels of one calibrated DMA block, copied in the DMA interrupt for the main loop */
+typedef struct
+{
+	/* Index of the first frame of the block in the sample ring numbering */
+	uint32_t SampleIndex;
+	/* Acquisition time of the first frame, unit: us */
+	uint32_t Timestamp;
+	/* Sampling rate of the block, unit: Hz */
+	uint32_t Sample_Rate;
+	/* Number of frames in the block */
+	uint32_t Frame_Num;
+	/* Calibrated voltage of every EMG channel, one row per channel, unit: mV */
+	uint16_t Data[ADC_EMG_CHANNEL_NUM][ADC_BLOCK_FRAME_MAX_NUM];
+}ADC_EMG_Block;
+
 
 /* Extern variables-----------------------------------------------------------*/
 
 /* Function declaration-------------------------------------------------------*/
 
+/* Set the window length of the moving average filter of every channel */
+t_FuncRet Set_ADC_MeanFilter_Window(uint16_t Window);
 /* Get the Mean filter voltage value */
 t_FuncRet Get_ADC_MeanFilter_Value(uint16_t* p_Sensor1_V_Data , 
 								   uint16_t* p_Sensor2_V_Data ,
@@ -38,6 +116,48 @@ t_FuncRet Get_ADC_KalmanFilter_Value(float* p_Sensor1_V_Data ,
 						             float* p_Sensor3_V_Data ,
 						             float* p_Sensor4_V_Data ,
 						             float* p_Vref_V_Data);
+/* Filter one channel of the latest block by the steady state Kalman filter */
+t_FuncRet Get_ADC_KalmanFilter_Block(ADC_Channel_ID Channel, float* p_DstBuff, uint32_t* p_Num);
+
+/* Obtain the latest block of DMA frames handed over by the ADC layer */
+t_FuncRet Get_ADC_Block_Data(uint16_t** pp_Block, uint32_t* p_Frame_Num);
+
+/* Set the oversampling ratio of one channel */
+t_FuncRet Set_ADC_Oversampling(ADC_Channel_ID Channel, uint16_t Ratio);
+/* Take the oversampled data of one rank out of its ring */
+t_FuncRet Get_ADC_Oversampled_Data(uint8_t Rank, uint16_t* p_DstBuff, uint32_t Max_Num, uint32_t* p_Num, uint8_t* p_Bits);
+/* Return the number of oversampled samples of one rank dropped because its ring was full */
+uint32_t Get_ADC_Oversampled_Overrun(uint8_t Rank);
+
+/* Select the coefficient set of the EMG biquad cascades */
+t_FuncRet Set_ADC_EMG_Filter(ADC_EMG_Filter_ID Filter_ID);
+/* Obtain one EMG channel of the latest block filtered by its biquad cascade */
+t_FuncRet Get_ADC_EMG_Filtered_Block(ADC_Channel_ID Channel, float32_t* p_DstBuff, uint32_t* p_Num);
+/* Return the cycles per sample spent by the last EMG biquad cascade call */
+uint32_t Get_ADC_EMG_Filter_Cycles(void);
+
+/* Obtain the amplitude of the tracked tones of one EMG channel */
+t_FuncRet Get_ADC_EMG_Tone_Magnitude(ADC_Channel_ID Channel, float32_t* p_Magnitude);
+
+/* Obtain the linear envelope of one EMG channel computed from the latest block */
+t_FuncRet Get_ADC_EMG_Envelope(ADC_Channel_ID Channel, float32_t* p_DstBuff, uint32_t* p_Num);
+
+/* Obtain one EMG channel of the latest block resampled to ADC_EMG_ALIGNED_RATE_HZ */
+t_FuncRet Get_ADC_EMG_Aligned(ADC_Channel_ID Channel, int16_t* p_DstBuff, uint32_t* p_Num);
+
+/* Set the window length of the EMG spectral analysis */
+t_FuncRet Set_ADC_EMG_Spectrum_Size(uint16_t FFT_Size);
+/* Filter the oldest queued EMG block and run the spectral analysis on every completed window */
+t_FuncRet ADC_EMG_Block_Process(void);
+/* Obtain the spectral features of the latest window of one EMG channel */
+t_FuncRet Get_ADC_EMG_Spectrum_Features(ADC_Channel_ID Channel, Spectrum_Features* p_Features, uint32_t* p_Timestamp);
+
+/* Acquire one mean filtered frame and push it into the sample ring (software polling mode) */
+t_FuncRet Push_ADC_MeanFilter_Frame(void);
+/* Take the oldest frame out of the sample ring */
+t_FuncRet Get_ADC_Frame(Sample_Frame* p_Frame);
+/* Obtain the state of the sample ring */
+t_FuncRet Get_ADC_SampleRing_State(uint32_t* p_Count, uint32_t* p_Overrun, uint32_t* p_High_Water);
 
 #ifdef __cplusplus
 }
@@ -9,6 +9,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "DigtalSignal_Process.h"
 #include "math.h"
+#include "string.h"
 
 /* Whether to use functions from the ARM-DSP library or use inefficient digital processing libraries */
 #if(_ARM_DSP_USED == 1)
@@ -24,10 +25,61 @@
 
 /* Private macro definitions--------------------------------------------------*/
 
+/* Pi used by the filter design */
+#define DSP_PI							3.14159265358979f
+/* Length of the test block of DataBuff_Kernel_Benchmark, not a multiple of 4 so that the remainder loops run too */
+#define DSP_BENCHMARK_SIZE				130U
+
+/* Element-wise kernel with the parameters fixed, the common form used by the benchmark table */
+typedef void (*DSP_Benchmark_Func)(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+
+/* One entry of the benchmark table: the kernel, its scalar reference and the sample type */
+typedef struct 
+{
+	const char*        Name;
+	DSP_Benchmark_Func Kernel;
+	DSP_Benchmark_Func Reference;
+	bool               Is_Q15;
+}DSP_Benchmark_Entry;
+
 /* Global variable------------------------------------------------------------*/
 
 /* Static function definition-------------------------------------------------*/
 
+/* Sum and sum of squares of a Q15 array */
+static void DSP_Accumulate_Q15(const int16_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Sum, int64_t* p_SumSq);
+/* Variance from the sum and the sum of squares of a Q15 array */
+static int64_t DSP_Var_Q30(int32_t Sum, int64_t SumSq, uint32_t Buff_Size);
+/* Square root of a positive integer */
+static uint32_t DSP_Sqrt_U64(uint64_t In);
+/* Square root of a Q31 number */
+static int32_t DSP_Sqrt_Q31(int32_t In);
+/* Update every bin of the sliding DFT bank with one sample */
+static inline void DSP_Sliding_DFT_Update(Sliding_DFT_Bank* p_Bank, float32_t In);
+/* One tap of the windowed sinc low pass used by the polyphase resamplers */
+static float32_t DSP_Polyphase_Tap(uint32_t Tap, uint32_t Tap_Num, float32_t Cutoff);
+/* Bring an angle into -180 ~ 180 deg */
+static inline float32_t DSP_Wrap_Angle(float32_t Angle);
+/* Kernels under test and their scalar references, in the common form of the benchmark table */
+static void DSP_Bench_Abs_F(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Abs_F_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Offset_F(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Offset_F_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Scale_F(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Scale_F_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Abs_Q15(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Abs_Q15_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Offset_Q15(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Offset_Q15_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Scale_Q15(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+static void DSP_Bench_Scale_Q15_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size);
+#if(_DSP_RFFT_USED == 0)
+/* In place radix-2 complex FFT */
+static void DSP_CFFT_Radix2(float32_t* p_Data, uint16_t Point_Num, const float32_t* p_Twiddle);
+/* Split the complex FFT of the even/odd samples into the real FFT */
+static void DSP_RFFT_Split(const float32_t* p_SrcBuff, float32_t* p_DstBuff, uint16_t FFT_Size, const float32_t* p_Twiddle);
+#endif
+
 /* Function definition--------------------------------------------------------*/
 
 /** 
@@ -110,6 +162,164 @@ void Mean_Filter_Rest_U16(Mean_Filter_U16* p_MeanFilterStruct)
 	 p_MeanFilterStruct->sum = 0;
 }
 
+/** 
+* @description: Initialize the moving average filter, the history is cleared
+* @param  {Moving_Average_U16*} p_Filter : Filter structure pointer
+* @param  {uint16_t}            Window   : Window length, 1 - MOVING_AVERAGE_WINDOW_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Moving_Average_Init_U16(Moving_Average_U16* p_Filter, uint16_t Window)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(!IS_MOVING_AVERAGE_WINDOW(Window))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	p_Filter->Sum    = 0;
+	p_Filter->Window = Window;
+	p_Filter->Index  = 0;
+	p_Filter->Count  = 0;
+	
+	return ret;
+}
+
+/** 
+* @description: Filter one sample by the moving average filter.
+*				The incoming sample replaces the oldest one in the history and in the running sum,
+*				until the history is filled the mean of the samples received so far is returned
+* @param  {Moving_Average_U16*} p_Filter : Filter structure pointer
+* @param  {uint16_t}            InData   : Filter input value
+* @return {uint16_t}                     : Mean of the last Window samples (rounded)
+* @author: leeqingshui 
+*/
+uint16_t Moving_Average_Update_U16(Moving_Average_U16* p_Filter, uint16_t InData)
+{
+	if(p_Filter->Count < p_Filter->Window)
+	{
+		p_Filter->Count++;
+	}
+	else
+	{
+		p_Filter->Sum = p_Filter->Sum - p_Filter->History[p_Filter->Index];
+	}
+	
+	p_Filter->History[p_Filter->Index] = InData;
+	p_Filter->Sum = p_Filter->Sum + InData;
+	
+	p_Filter->Index++;
+	if(p_Filter->Index >= p_Filter->Window)
+	{
+		p_Filter->Index = 0;
+	}
+	
+	return (uint16_t)((p_Filter->Sum + (p_Filter->Count >> 1)) / p_Filter->Count);
+}
+
+/** 
+* @description: Filter a block of samples by the moving average filter, the history goes on across blocks.
+*				With Stride = ADC_SCAN_RANK_NUM one channel of a DMA block is filtered in place of the block
+* @param  {Moving_Average_U16*} p_Filter  : Filter structure pointer
+* @param  {uint16_t*}           p_SrcBuff : First input sample
+* @param  {uint32_t}            Stride    : Distance between two input samples, in samples
+* @param  {uint16_t*}           p_DstBuff : Filter output, Buff_Size continuous samples
+* @param  {uint32_t}            Buff_Size : Number of samples
+* @return {void} 
+* @author: leeqingshui 
+*/
+void Moving_Average_Block_U16(Moving_Average_U16* p_Filter, const uint16_t* p_SrcBuff, uint32_t Stride, uint16_t* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		p_DstBuff[i] = Moving_Average_Update_U16(p_Filter, *p_SrcBuff);
+		p_SrcBuff    = p_SrcBuff + Stride;
+	}
+}
+
+/** 
+* @description: Initialize the moving average filter, the history is cleared
+* @param  {Moving_Average_F*} p_Filter : Filter structure pointer
+* @param  {uint16_t}          Window   : Window length, 1 - MOVING_AVERAGE_WINDOW_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Moving_Average_Init_F(Moving_Average_F* p_Filter, uint16_t Window)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(!IS_MOVING_AVERAGE_WINDOW(Window))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	p_Filter->Sum    = 0;
+	p_Filter->Window = Window;
+	p_Filter->Index  = 0;
+	p_Filter->Count  = 0;
+	
+	return ret;
+}
+
+/** 
+* @description: Filter one sample by the moving average filter.
+*				The running sum is summed again from the history every time the history wraps,
+*				so the rounding error of the add/subtract updates does not build up
+* @param  {Moving_Average_F*} p_Filter : Filter structure pointer
+* @param  {float}             InData   : Filter input value
+* @return {float}                      : Mean of the last Window samples
+* @author: leeqingshui 
+*/
+float Moving_Average_Update_F(Moving_Average_F* p_Filter, float InData)
+{
+	if(p_Filter->Count < p_Filter->Window)
+	{
+		p_Filter->Count++;
+	}
+	else
+	{
+		p_Filter->Sum = p_Filter->Sum - p_Filter->History[p_Filter->Index];
+	}
+	
+	p_Filter->History[p_Filter->Index] = InData;
+	p_Filter->Sum = p_Filter->Sum + InData;
+	
+	p_Filter->Index++;
+	if(p_Filter->Index >= p_Filter->Window)
+	{
+		p_Filter->Index = 0;
+		
+		/* Once per window: O(1) per sample on average */
+		p_Filter->Sum = 0;
+		for(uint16_t i = 0; i < p_Filter->Count; i++)
+		{
+			p_Filter->Sum = p_Filter->Sum + p_Filter->History[i];
+		}
+	}
+	
+	return p_Filter->Sum / p_Filter->Count;
+}
+
+/** 
+* @description: Filter a block of samples by the moving average filter, the history goes on across blocks
+* @param  {Moving_Average_F*} p_Filter  : Filter structure pointer
+* @param  {float*}            p_SrcBuff : First input sample
+* @param  {uint32_t}          Stride    : Distance between two input samples, in samples
+* @param  {float*}            p_DstBuff : Filter output, Buff_Size continuous samples
+* @param  {uint32_t}          Buff_Size : Number of samples
+* @return {void} 
+* @author: leeqingshui 
+*/
+void Moving_Average_Block_F(Moving_Average_F* p_Filter, const float* p_SrcBuff, uint32_t Stride, float* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		p_DstBuff[i] = Moving_Average_Update_F(p_Filter, *p_SrcBuff);
+		p_SrcBuff    = p_SrcBuff + Stride;
+	}
+}
+
 /** 
 * @description: Initialize the Kalman filter
 * @param  {Kalman_Filter*} p_Kalman_Filter : Filter structure pointer
@@ -150,384 +360,2719 @@ float KalmanFilter_Calculate(Kalman_Filter* p_Kalman_Filter , float InData)
 	return (p_Kalman_Filter->now_data);
 }
 
+/** 
+* @description: Initialize the Kalman filter bank, every channel gets the parameters of KalmanFilter_Init
+* @param  {Kalman_Filter_Bank*} p_Bank      : Filter bank structure pointer
+* @param  {uint32_t}            Channel_Num : Number of channels, 1 - FILTER_BANK_CHANNEL_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet KalmanFilter_Bank_Init(Kalman_Filter_Bank* p_Bank, uint32_t Channel_Num)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(!IS_FILTER_BANK_CHANNEL_NUM(Channel_Num))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	for(uint32_t ch = 0; ch < Channel_Num; ch++)
+	{
+		p_Bank->error[ch]     = 0.01;
+		p_Bank->last_data[ch] = 0;
+		p_Bank->q[ch]         = 0.01;
+		p_Bank->r[ch]         = 0.01;
+		p_Bank->kGain[ch]     = 0;
+		p_Bank->Steady[ch]    = (bool)FALSE;
+	}
+	p_Bank->Channel_Num = Channel_Num;
+	
+	return ret;
+}
 
 /** 
-* @description: Get the absolute value of an array
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t*} p_DstpBuff : A pointer to the processed array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: One frame is filtered by the Kalman filter bank, the same steps as KalmanFilter_Calculate.
+*				Every step is one loop over the contiguous arrays of all channels.
+*				A channel whose gain has stopped changing keeps it and skips the division
+* @param  {Kalman_Filter_Bank*} p_Bank    : Filter bank structure pointer
+* @param  {float*}              p_InData  : One sample of every channel
+* @param  {float*}              p_OutData : Kalman filter prediction value of every channel
+* @return {void} 
 * @author: leeqingshui 
 */
-void Get_DataBuff_Abs(float32_t* p_SrcBuff,float32_t* p_DstpBuff,uint32_t Buff_Size)
-{	
-	#if(_DSP_ABS_USED == 1)
-		arm_abs_f32(p_SrcBuff,p_DstpBuff,Buff_Size);
-	#else
-		for(uint32_t i = 0;i<Buff_Size;i++)
+void KalmanFilter_Bank_Calculate(Kalman_Filter_Bank* p_Bank, const float* p_InData, float* p_OutData)
+{
+	uint32_t Channel_Num = p_Bank->Channel_Num;
+	
+	/* Predict the deviation and compute the Kalman gain of the channels still converging */
+	for(uint32_t ch = 0; ch < Channel_Num; ch++)
+	{
+		if(p_Bank->Steady[ch] == (bool)FALSE)
 		{
-			if((*(p_SrcBuff + i))<0)
+			float Last_Gain = p_Bank->kGain[ch];
+			
+			p_Bank->error[ch] = p_Bank->error[ch] + p_Bank->q[ch];
+			p_Bank->kGain[ch] = p_Bank->error[ch]/(p_Bank->error[ch] + p_Bank->r[ch]);
+			p_Bank->error[ch] = (1 - p_Bank->kGain[ch])*p_Bank->error[ch];
+			
+			if(fabsf(p_Bank->kGain[ch] - Last_Gain) <= KALMAN_STEADY_TOLERANCE*p_Bank->kGain[ch])
 			{
-				*(p_DstpBuff + i) = -(*(p_SrcBuff + i));
+				p_Bank->Steady[ch] = (bool)TRUE;
 			}
 		}
-	#endif
+	}
+	
+	/* Calculate the filter estimate */
+	for(uint32_t ch = 0; ch < Channel_Num; ch++)
+	{
+		p_Bank->last_data[ch] = p_Bank->last_data[ch] + p_Bank->kGain[ch]*(p_InData[ch] - p_Bank->last_data[ch]);
+		p_OutData[ch]         = p_Bank->last_data[ch];
+	}
 }
 
-/* !! 
-	This function causes Hardfault for an unknown reason and does not perform properly !!
-	Notice here that if you use sizeof on an array to find its length, it will cause Hardfault
-*/
 /** 
-* @description: Get the offset additioned value of an array
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t}  offset     : Data offset
-* @param  {float32_t*} p_DstpBuff : A pointer to the processed array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: Give every channel of the Kalman filter bank its steady state gain at once.
+*				With constant q and r the gain converges to K = P/(P + r), P = (q + sqrt(q^2 + 4*q*r))/2,
+*				from then on the filter is the first order IIR y = y + K*(x - y) and no division is done
+* @param  {Kalman_Filter_Bank*} p_Bank : Filter bank structure pointer
+* @return {void} 
 * @author: leeqingshui 
 */
-void Get_DataBuff_Offeset(float32_t* p_SrcBuff, float32_t offset,float32_t* p_DstpBuff,uint32_t Buff_Size)
+void KalmanFilter_Bank_Set_Steady(Kalman_Filter_Bank* p_Bank)
 {
-	#if(_DSP_OFFSET_USED == 1)
-		arm_offset_f32(p_SrcBuff, offset, p_DstpBuff, Buff_Size);	
-
-	#else
-		for(uint32_t i = 0;i<Buff_Size;i++)
-		{
-			*(p_DstpBuff + i) = *(p_SrcBuff + i) + offset;
-		}
-	
-	#endif
+	for(uint32_t ch = 0; ch < p_Bank->Channel_Num; ch++)
+	{
+		float q      = p_Bank->q[ch];
+		float r      = p_Bank->r[ch];
+		float P_Pred = 0.5f*(q + sqrtf(q*q + 4*q*r));
+		
+		p_Bank->kGain[ch]  = P_Pred/(P_Pred + r);
+		p_Bank->error[ch]  = (1 - p_Bank->kGain[ch])*P_Pred;
+		p_Bank->Steady[ch] = (bool)TRUE;
+	}
 }
 
-/* !! 
-	This function causes Hardfault for an unknown reason and does not perform properly !!
-	Notice here that if you use sizeof on an array to find its length, it will cause Hardfault
-*/
 /** 
-* @description: Computes the maximum value of the data array. This function returns the maximum value and its position in the array
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @param  {float32_t*} p_Result   : the maximum value of the data array
-* @param  {uint32_t*}  p_Index    : The maximum element is indexed in the array
-* @return {void}                         
+* @description: Filter a block of samples of one channel by the Kalman filter bank, the state goes on across blocks.
+*				Until the channel has converged every sample is one KalmanFilter_Calculate step. 
+*				After that it is the fixed gain IIR computed 4 samples at a time: each of the 4 outputs depends only
+*				on the output before the group, y[n+k] = a^k*y[n] + K*(a^(k-1)*x[n+1] + ... + x[n+k]), a = 1 - K,
+*				so the multiplications do not wait on each other
+* @param  {Kalman_Filter_Bank*} p_Bank     : Filter bank structure pointer
+* @param  {uint32_t}            Channel    : Channel of the bank, 0 ~ Channel_Num-1
+* @param  {uint16_t*}           p_SrcBuff  : Input block
+* @param  {uint32_t}            Stride     : Distance between two samples of the input, unit: uint16_t
+* @param  {float*}              p_DstBuff  : Kalman filter prediction value of every sample
+* @param  {uint32_t}            Block_Size : Number of samples
+* @return {void} 
 * @author: leeqingshui 
 */
-void Get_DataBuff_Max(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result, uint32_t* p_Index)
+void KalmanFilter_Bank_Process_U16(Kalman_Filter_Bank* p_Bank, uint32_t Channel, const uint16_t* p_SrcBuff, uint32_t Stride, float* p_DstBuff, uint32_t Block_Size)
 {
-	#if(_DSP_MAX_USED == 1)
-		arm_max_f32 (p_SrcBuff, Buff_Size, p_Result, p_Index);
+	float    y = p_Bank->last_data[Channel];
+	uint32_t i = 0;
 	
-	#else
-		// Assume that the first element in the array is the maximum value
-		float32_t temp_max = *p_SrcBuff;
-		uint32_t  temp_index = 0;
+	/* Converging: the gain changes with every sample */
+	for(; (i < Block_Size) && (p_Bank->Steady[Channel] == (bool)FALSE); i++)
+	{
+		float Last_Gain = p_Bank->kGain[Channel];
 		
-		// Go through the group, getting each element, ready to compare
-		for(uint32_t i = 1; i < Buff_Size; i++)
+		p_Bank->error[Channel] = p_Bank->error[Channel] + p_Bank->q[Channel];
+		p_Bank->kGain[Channel] = p_Bank->error[Channel]/(p_Bank->error[Channel] + p_Bank->r[Channel]);
+		y                      = y + p_Bank->kGain[Channel]*((float)p_SrcBuff[i*Stride] - y);
+		p_Bank->error[Channel] = (1 - p_Bank->kGain[Channel])*p_Bank->error[Channel];
+		p_DstBuff[i]           = y;
+		
+		if(fabsf(p_Bank->kGain[Channel] - Last_Gain) <= KALMAN_STEADY_TOLERANCE*p_Bank->kGain[Channel])
 		{
-			// If something larger than max occurs during the comparison, let max record the larger value
-			if((*(p_SrcBuff + i)) > temp_max)
-			{
-					temp_max = *(p_SrcBuff + i);
-					temp_index = i;
-			}
+			p_Bank->Steady[Channel] = (bool)TRUE;
 		}
+	}
+	
+	if(i < Block_Size)
+	{
+		float K  = p_Bank->kGain[Channel];
+		float a  = 1 - K;
+		float a2 = a*a;
+		float a3 = a2*a;
+		float a4 = a2*a2;
 		
-		// The loop ends and the result is retrieved
-		*p_Result = temp_max;
-		*p_Index  = temp_index;
-		
-	#endif
+		for(; i + 4 <= Block_Size; i += 4)
+		{
+			float x1 = (float)p_SrcBuff[i*Stride];
+			float x2 = (float)p_SrcBuff[(i + 1)*Stride];
+			float x3 = (float)p_SrcBuff[(i + 2)*Stride];
+			float x4 = (float)p_SrcBuff[(i + 3)*Stride];
+			
+			p_DstBuff[i]     = a*y  + K*x1;
+			p_DstBuff[i + 1] = a2*y + K*(a*x1 + x2);
+			p_DstBuff[i + 2] = a3*y + K*(a2*x1 + a*x2 + x3);
+			p_DstBuff[i + 3] = a4*y + K*(a3*x1 + a2*x2 + a*x3 + x4);
+			y                = p_DstBuff[i + 3];
+		}
+		for(; i < Block_Size; i++)
+		{
+			y            = a*y + K*(float)p_SrcBuff[i*Stride];
+			p_DstBuff[i] = y;
+		}
+	}
+	
+	p_Bank->last_data[Channel] = y;
 }
 
 /** 
-* @description: Computes the maximum value of the data array. This function returns the maximum value and its position in the array
-* @param  {uint16_t*}  p_SrcBuff  : A pointer to the array to be processed
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @param  {uint16_t*}  p_Result   : the maximum value of the data array
-* @param  {uint32_t*}  p_Index    : The maximum element is indexed in the array
-* @return {void}                         
+* @description: Initialize the angle Kalman filter of one axis (state: angle and gyro bias).
+*				The angle covariance starts large, so the first measured angle is taken almost as it is.
+*				The CMSIS matrix instances point into the structure, it must not be copied after this call
+* @param  {Kalman_Angle_Filter*} p_Filter : Filter structure pointer
+* @param  {float32_t}            Dt       : Update period, unit: s
+* @param  {float32_t}            Q_Angle  : Process noise of the angle for one period, unit: deg^2
+* @param  {float32_t}            Q_Bias   : Process noise of the gyro bias for one period, unit: (deg/s)^2
+* @param  {float32_t}            R_Angle  : Measurement noise of the angle, unit: deg^2
+* @return {t_FuncRet } : if success,return Operation_Success
 * @author: leeqingshui 
 */
-void Get_DataBuff_Max_U16(uint16_t* p_SrcBuff, uint32_t Buff_Size, uint16_t* p_Result, uint32_t* p_Index)
+t_FuncRet Kalman_Angle_Init(Kalman_Angle_Filter* p_Filter, float32_t Dt, float32_t Q_Angle, float32_t Q_Bias, float32_t R_Angle)
 {
-    // Assume that the first element in the array is the maximum value
-    uint16_t  temp_max = *p_SrcBuff;
-    uint32_t  temp_index = 0;
-    
-    // Go through the group, getting each element, ready to compare
-    for(uint32_t i = 1; i < Buff_Size; i++)
-    {
-        // If something larger than max occurs during the comparison, let max record the larger value
-        if((*(p_SrcBuff + i)) > temp_max)
-        {
-                temp_max = *(p_SrcBuff + i);
-                temp_index = i;
-        }
-    }
-    
-    // The loop ends and the result is retrieved
-    *p_Result = temp_max;
-    *p_Index  = temp_index;
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((p_Filter == NULL) || (Dt <= 0) || (Q_Angle < 0) || (Q_Bias < 0) || (R_Angle <= 0))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	p_Filter->State[0] = 0;
+	p_Filter->State[1] = 0;
+	
+	/* Row major 2x2: F = [1 -Dt; 0 1] */
+	p_Filter->F[0]   = 1;   p_Filter->F[1]   = -Dt; p_Filter->F[2]   = 0;   p_Filter->F[3]   = 1;
+	p_Filter->F_T[0] = 1;   p_Filter->F_T[1] = 0;   p_Filter->F_T[2] = -Dt; p_Filter->F_T[3] = 1;
+	p_Filter->Q[0]   = Q_Angle; p_Filter->Q[1] = 0; p_Filter->Q[2]   = 0;   p_Filter->Q[3]   = Q_Bias;
+	p_Filter->P[0]   = KALMAN_ANGLE_P0_ANGLE; p_Filter->P[1] = 0; p_Filter->P[2] = 0; p_Filter->P[3] = KALMAN_ANGLE_P0_BIAS;
+	p_Filter->R      = R_Angle;
+	p_Filter->Dt     = Dt;
+	
+	#if(_DSP_MATRIX_USED == 1)
+		arm_mat_init_f32(&p_Filter->Mat_P,    2, 2, p_Filter->P);
+		arm_mat_init_f32(&p_Filter->Mat_F,    2, 2, p_Filter->F);
+		arm_mat_init_f32(&p_Filter->Mat_F_T,  2, 2, p_Filter->F_T);
+		arm_mat_init_f32(&p_Filter->Mat_Q,    2, 2, p_Filter->Q);
+		arm_mat_init_f32(&p_Filter->Mat_Temp, 2, 2, p_Filter->Temp);
+	#endif
+	
+	return ret;
 }
 
-/* !! 
-	This function causes Hardfault for an unknown reason and does not perform properly !!
-	Notice here that if you use sizeof on an array to find its length, it will cause Hardfault
-*/
 /** 
-* @description: The target array is multiplied by the proportionality constant
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t}  ratio      : the proportionality constant
-* @param  {float32_t*} p_DstpBuff : A pointer to the processed array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: One update of the angle Kalman filter: the measured rate minus the estimated bias predicts the angle,
+*				the measured angle corrects the angle and the bias. No loop and one division, the cost of every
+*				update is the same. Angles are kept in -180 ~ 180 deg, the innovation takes the short way round
+* @param  {Kalman_Angle_Filter*} p_Filter : Filter structure pointer
+* @param  {float32_t}            Angle    : Measured angle, unit: deg
+* @param  {float32_t}            Rate     : Measured angular rate, unit: deg/s
+* @return {float32_t}                     : Estimated angle, unit: deg
 * @author: leeqingshui 
 */
-void Get_DataBuff_Scale(float32_t* p_SrcBuff, float32_t ratio,float32_t* p_DstpBuff,uint32_t Buff_Size)
+float32_t Kalman_Angle_Update(Kalman_Angle_Filter* p_Filter, float32_t Angle, float32_t Rate)
 {
-	#if(_DSP_SCALE_USED == 1)
-		arm_scale_f32(p_SrcBuff, ratio, p_DstpBuff, Buff_Size);	
+	float32_t* P = p_Filter->P;
+	float32_t  Innovation, S, K0, K1, P00, P01;
+	
+	/* Predict the state: x = F*x + B*Rate */
+	p_Filter->State[0] = DSP_Wrap_Angle(p_Filter->State[0] + p_Filter->Dt*(Rate - p_Filter->State[1]));
 	
+	/* Predict the covariance: P = F*P*F' + Q */
+	#if(_DSP_MATRIX_USED == 1)
+		arm_mat_mult_f32(&p_Filter->Mat_F, &p_Filter->Mat_P, &p_Filter->Mat_Temp);
+		arm_mat_mult_f32(&p_Filter->Mat_Temp, &p_Filter->Mat_F_T, &p_Filter->Mat_P);
+		arm_mat_add_f32(&p_Filter->Mat_P, &p_Filter->Mat_Q, &p_Filter->Mat_P);
 	#else
-		for(uint32_t i = 0;i<Buff_Size;i++)
 		{
-			*(p_DstpBuff + i) = *(p_SrcBuff + i)*ratio;
+			float32_t* T  = p_Filter->Temp;
+			float32_t  Dt = p_Filter->Dt;
+			
+			T[0] = P[0] - Dt*P[2];
+			T[1] = P[1] - Dt*P[3];
+			T[2] = P[2];
+			T[3] = P[3];
+			
+			P[0] = T[0] - Dt*T[1] + p_Filter->Q[0];
+			P[1] = T[1];
+			P[2] = T[2] - Dt*T[3];
+			P[3] = T[3] + p_Filter->Q[3];
 		}
-	
 	#endif
+	
+	/* Kalman gain for H = [1 0]: K = P*H'/(H*P*H' + R) */
+	S  = P[0] + p_Filter->R;
+	K0 = P[0]/S;
+	K1 = P[2]/S;
+	
+	/* Correct the state */
+	Innovation         = DSP_Wrap_Angle(Angle - p_Filter->State[0]);
+	p_Filter->State[0] = DSP_Wrap_Angle(p_Filter->State[0] + K0*Innovation);
+	p_Filter->State[1] = p_Filter->State[1] + K1*Innovation;
+	
+	/* Correct the covariance: P = (I - K*H)*P */
+	P00  = P[0];
+	P01  = P[1];
+	P[0] = P[0] - K0*P00;
+	P[1] = P[1] - K0*P01;
+	P[2] = P[2] - K1*P00;
+	P[3] = P[3] - K1*P01;
+	
+	return p_Filter->State[0];
 }
 
 /** 
-* @description: Get the array average
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t*} p_Result   : Average of array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: Initialize the moving average filter bank, the history is cleared
+* @param  {Moving_Average_Bank_F*} p_Bank      : Filter bank structure pointer
+* @param  {uint32_t}               Channel_Num : Number of channels, 1 - FILTER_BANK_CHANNEL_MAX
+* @param  {uint16_t}               Window      : Window length, 1 - MOVING_AVERAGE_BANK_WINDOW_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
 * @author: leeqingshui 
 */
-void Get_DataBuff_Mean(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+t_FuncRet Moving_Average_Bank_Init_F(Moving_Average_Bank_F* p_Bank, uint32_t Channel_Num, uint16_t Window)
 {
-	#if(_DSP_MEAN_USED == 1)
-		arm_mean_f32(p_SrcBuff, Buff_Size, p_Result);	
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	#else
-		float sum = 0;
-		
-		for(uint32_t i = 0;i<Buff_Size;i++)
-		{
-			sum = sum + *(p_SrcBuff+i);
-		}
-		
-		*p_Result = sum/Buff_Size;
+	if((!IS_FILTER_BANK_CHANNEL_NUM(Channel_Num)) || (Window < 1) || (Window > MOVING_AVERAGE_BANK_WINDOW_MAX))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
 	
-	#endif
+	for(uint32_t ch = 0; ch < Channel_Num; ch++)
+	{
+		p_Bank->Sum[ch] = 0;
+	}
+	p_Bank->Channel_Num = Channel_Num;
+	p_Bank->Window      = Window;
+	p_Bank->Index       = 0;
+	p_Bank->Count       = 0;
+	
+	return ret;
 }
 
 /** 
-* @description: Get the array average
-* @param  {uint16_t*}  p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t*} p_Result   : Average of array
-* @param  {uint16_t*}  Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: One frame is filtered by the moving average filter bank.
+*				The oldest frame is subtracted from the sums of all channels and the new frame is added,
+*				the sums are summed again from the history every time the history wraps
+* @param  {Moving_Average_Bank_F*} p_Bank    : Filter bank structure pointer
+* @param  {float*}                 p_InData  : One sample of every channel
+* @param  {float*}                 p_OutData : Mean of the last Window samples of every channel
+* @return {void} 
 * @author: leeqingshui 
 */
-void Get_DataBuff_Mean_U16(uint16_t* p_SrcBuff, uint32_t Buff_Size, uint16_t* p_Result)
+void Moving_Average_Bank_Update_F(Moving_Average_Bank_F* p_Bank, const float* p_InData, float* p_OutData)
 {
-    uint32_t sum = 0;
-    
-    for(uint32_t i = 0;i<Buff_Size;i++)
-    {
-        sum = sum + *(p_SrcBuff+i);
-    }
-    
-    *p_Result = (uint16_t)sum/Buff_Size;
-}
-
-/** 
-* @description: Computes the minimum value of the data array. This function returns the minimum value and its position in the array
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @param  {float32_t*} p_Result   : the minimum value of the data array
-* @param  {uint32_t*}  p_Index    : The minimum element is indexed in the array
-* @return {void}                         
-* @author: leeqingshui 
-*/
-void Get_DataBuff_Min(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result, uint32_t* p_Index)
-{
-	#if(_DSP_MIN_USED == 1)
-		arm_min_f32 (p_SrcBuff, Buff_Size, p_Result, p_Index);
+	uint32_t Channel_Num = p_Bank->Channel_Num;
+	float*   p_Row       = p_Bank->History[p_Bank->Index];
+	
+	if(p_Bank->Count < p_Bank->Window)
+	{
+		p_Bank->Count++;
+	}
+	else
+	{
+		#if(_DSP_FILTER_BANK_USED == 1)
+			arm_sub_f32(p_Bank->Sum, p_Row, p_Bank->Sum, Channel_Num);
+		#else
+			for(uint32_t ch = 0; ch < Channel_Num; ch++)
+			{
+				p_Bank->Sum[ch] = p_Bank->Sum[ch] - p_Row[ch];
+			}
+		#endif
+	}
 	
+	#if(_DSP_FILTER_BANK_USED == 1)
+		arm_copy_f32((float32_t*)p_InData, p_Row, Channel_Num);
+		arm_add_f32(p_Bank->Sum, p_Row, p_Bank->Sum, Channel_Num);
 	#else
-		// Assume that the first element in the array is the maximum value
-		float32_t temp_min = *p_SrcBuff;
-		uint32_t  temp_index = 0;
+		for(uint32_t ch = 0; ch < Channel_Num; ch++)
+		{
+			p_Row[ch]       = p_InData[ch];
+			p_Bank->Sum[ch] = p_Bank->Sum[ch] + p_Row[ch];
+		}
+	#endif
+	
+	p_Bank->Index++;
+	if(p_Bank->Index >= p_Bank->Window)
+	{
+		p_Bank->Index = 0;
 		
-		// Go through the group, getting each element, ready to compare
-		for(uint32_t i = 1; i < Buff_Size; i++)
+		/* Once per window: O(1) per frame on average */
+		for(uint32_t ch = 0; ch < Channel_Num; ch++)
 		{
-			// If something larger than max occurs during the comparison, let max record the larger value
-			if((*(p_SrcBuff + i)) < temp_min)
+			p_Bank->Sum[ch] = 0;
+		}
+		for(uint16_t i = 0; i < p_Bank->Count; i++)
+		{
+			for(uint32_t ch = 0; ch < Channel_Num; ch++)
 			{
-					temp_min = *(p_SrcBuff + i);
-					temp_index = i;
+				p_Bank->Sum[ch] = p_Bank->Sum[ch] + p_Bank->History[i][ch];
 			}
 		}
-		
-		// The loop ends and the result is retrieved
-		*p_Result = temp_min;
-		*p_Index  = temp_index;
-		
+	}
+	
+	#if(_DSP_FILTER_BANK_USED == 1)
+		arm_scale_f32(p_Bank->Sum, 1.0f/p_Bank->Count, p_OutData, Channel_Num);
+	#else
+		for(uint32_t ch = 0; ch < Channel_Num; ch++)
+		{
+			p_OutData[ch] = p_Bank->Sum[ch] / p_Bank->Count;
+		}
 	#endif
 }
 
 /** 
-* @description: Computes the minimum value of the data array. This function returns the minimum value and its position in the array
-* @param  {uint16_t*}  p_SrcBuff  : A pointer to the array to be processed
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @param  {uint16_t*}  p_Result   : the minimum value of the data array
-* @param  {uint32_t*}  p_Index    : The minimum element is indexed in the array
-* @return {void}                         
+* @description: Design the coefficients of one second order stage (RBJ audio EQ cookbook).
+*				The coefficients are normalized by a0 and written in the CMSIS order b0, b1, b2, a1, a2
+*				with the sign of a1 and a2 inverted
+* @param  {Biquad_Type} Type        : Low pass, high pass or notch
+* @param  {float32_t}   Sample_Rate : Sampling rate, unit: Hz
+* @param  {float32_t}   F0          : Cut-off (or notch) frequency, unit: Hz, 0 < F0 < Sample_Rate/2
+* @param  {float32_t}   Q           : Quality factor, 0.7071 for a Butterworth stage
+* @param  {float32_t*}  p_Coeffs    : BIQUAD_COEFF_NUM coefficients of the stage
+* @return {t_FuncRet } : if success,return Operation_Success
 * @author: leeqingshui 
 */
-void Get_DataBuff_Min_U16(uint16_t* p_SrcBuff, uint32_t Buff_Size, uint16_t* p_Result, uint32_t* p_Index)
+t_FuncRet Biquad_Design(Biquad_Type Type, float32_t Sample_Rate, float32_t F0, float32_t Q, float32_t* p_Coeffs)
 {
-    // Assume that the first element in the array is the maximum value
-    uint16_t  temp_min = *p_SrcBuff;
-    uint32_t  temp_index = 0;
-    
-    // Go through the group, getting each element, ready to compare
-    for(uint32_t i = 1; i < Buff_Size; i++)
-    {
-        // If something larger than max occurs during the comparison, let max record the larger value
-        if((*(p_SrcBuff + i)) < temp_min)
-        {
-                temp_min = *(p_SrcBuff + i);
-                temp_index = i;
-        }
-    }
-    
-    // The loop ends and the result is retrieved
-    *p_Result = temp_min;
-    *p_Index  = temp_index;
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	float32_t w0    = 0;
+	float32_t cosw0 = 0;
+	float32_t alpha = 0;
+	float32_t a0    = 0;
+	
+	if((F0 <= 0) || (F0 >= Sample_Rate/2) || (Q <= 0))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	w0    = 2*DSP_PI*F0/Sample_Rate;
+	cosw0 = cosf(w0);
+	alpha = sinf(w0)/(2*Q);
+	a0    = 1 + alpha;
+	
+	switch(Type)
+	{
+		case BIQUAD_LOWPASS:
+			p_Coeffs[0] = ((1 - cosw0)/2)/a0;
+			p_Coeffs[1] = (1 - cosw0)/a0;
+			p_Coeffs[2] = ((1 - cosw0)/2)/a0;
+			break;
+		
+		case BIQUAD_HIGHPASS:
+			p_Coeffs[0] = ((1 + cosw0)/2)/a0;
+			p_Coeffs[1] = -(1 + cosw0)/a0;
+			p_Coeffs[2] = ((1 + cosw0)/2)/a0;
+			break;
+		
+		case BIQUAD_NOTCH:
+			p_Coeffs[0] = 1/a0;
+			p_Coeffs[1] = (-2*cosw0)/a0;
+			p_Coeffs[2] = 1/a0;
+			break;
+		
+		default:
+			return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	p_Coeffs[3] = (2*cosw0)/a0;
+	p_Coeffs[4] = -(1 - alpha)/a0;
+	
+	return ret;
 }
 
 /** 
-* @description: Gets the sum of squares in the array
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t*} p_Result   : the sum of squares of array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: Load a coefficient set into the floating point biquad cascade and clear its state.
+*				Calling it again with another set switches the filter at run time
+* @param  {Biquad_Cascade_F*} p_Cascade : Biquad cascade structure pointer
+* @param  {float32_t*}        p_Coeffs  : BIQUAD_COEFF_NUM coefficients of every stage
+* @param  {uint8_t}           Stage_Num : Number of stages, 1 - BIQUAD_STAGE_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
 * @author: leeqingshui 
 */
-void Get_DataBuff_Power(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+t_FuncRet Biquad_Cascade_Init_F(Biquad_Cascade_F* p_Cascade, const float32_t* p_Coeffs, uint8_t Stage_Num)
 {
-	#if(_DSP_POWER_USED == 1)
-		arm_power_f32(p_SrcBuff, Buff_Size, p_Result);	
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((Stage_Num < 1) || (Stage_Num > BIQUAD_STAGE_MAX))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	for(uint32_t i = 0; i < BIQUAD_COEFF_NUM*Stage_Num; i++)
+	{
+		p_Cascade->Coeffs[i] = p_Coeffs[i];
+	}
+	for(uint32_t i = 0; i < 2*Stage_Num; i++)
+	{
+		p_Cascade->State[i] = 0;
+	}
+	p_Cascade->Stage_Num = Stage_Num;
 	
+	return ret;
+}
+
+/** 
+* @description: Filter a block of samples by the floating point biquad cascade, the state goes on across blocks.
+*				Every stage runs over the whole block before the next one, so its coefficients stay in registers
+* @param  {Biquad_Cascade_F*} p_Cascade  : Biquad cascade structure pointer
+* @param  {float32_t*}        p_SrcBuff  : Input block
+* @param  {float32_t*}        p_DstBuff  : Output block, it can be the input block
+* @param  {uint32_t}          Block_Size : Number of samples
+* @return {void} 
+* @author: leeqingshui 
+*/
+void Biquad_Cascade_Process_F(Biquad_Cascade_F* p_Cascade, const float32_t* p_SrcBuff, float32_t* p_DstBuff, uint32_t Block_Size)
+{
+	#if(_DSP_BIQUAD_USED == 1)
+		arm_biquad_cascade_df2T_instance_f32 S = {p_Cascade->Stage_Num, p_Cascade->State, p_Cascade->Coeffs};
+		
+		arm_biquad_cascade_df2T_f32(&S, (float32_t*)p_SrcBuff, p_DstBuff, Block_Size);
 	#else
-		float power = 0;
+		const float32_t* p_In = p_SrcBuff;
 		
-		for(uint32_t i = 0;i<Buff_Size;i++)
+		for(uint8_t stage = 0; stage < p_Cascade->Stage_Num; stage++)
 		{
-			power = (*(p_SrcBuff+i))*(*(p_SrcBuff+i)) + power;
+			const float32_t* p_Coeffs = &p_Cascade->Coeffs[BIQUAD_COEFF_NUM*stage];
+			float32_t b0 = p_Coeffs[0], b1 = p_Coeffs[1], b2 = p_Coeffs[2], a1 = p_Coeffs[3], a2 = p_Coeffs[4];
+			float32_t d1 = p_Cascade->State[2*stage];
+			float32_t d2 = p_Cascade->State[2*stage + 1];
+			
+			for(uint32_t i = 0; i < Block_Size; i++)
+			{
+				float32_t x = p_In[i];
+				float32_t y = b0*x + d1;
+				
+				d1 = b1*x + a1*y + d2;
+				d2 = b2*x + a2*y;
+				p_DstBuff[i] = y;
+			}
+			
+			p_Cascade->State[2*stage]     = d1;
+			p_Cascade->State[2*stage + 1] = d2;
+			
+			/* The next stage filters the output of this one */
+			p_In = p_DstBuff;
 		}
-		
-		*p_Result = power;
-	
 	#endif
 }
 
 /** 
-* @description: Gets the Root Mean Sqaure of the array
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t*} p_Result   : the Root Mean Sqaure of squares of array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: Load a coefficient set into the Q31 biquad cascade and clear its state.
+*				The floating point coefficients are scaled by 2^-BIQUAD_Q31_POST_SHIFT and rounded to Q31
+* @param  {Biquad_Cascade_Q31*} p_Cascade : Biquad cascade structure pointer
+* @param  {float32_t*}          p_Coeffs  : BIQUAD_COEFF_NUM coefficients of every stage (as from Biquad_Design)
+* @param  {uint8_t}             Stage_Num : Number of stages, 1 - BIQUAD_STAGE_MAX
+* @return {t_FuncRet } : if success,return Operation_Success, Operation_Fail if a coefficient does not fit
 * @author: leeqingshui 
 */
-void Get_DataBuff_Rms(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+t_FuncRet Biquad_Cascade_Init_Q31(Biquad_Cascade_Q31* p_Cascade, const float32_t* p_Coeffs, uint8_t Stage_Num)
 {
-	#if(_DSP_RMS_USED == 1)
-		arm_rms_f32(p_SrcBuff, Buff_Size, p_Result);	
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	#else
-		float power = 0;
+	if((Stage_Num < 1) || (Stage_Num > BIQUAD_STAGE_MAX))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	for(uint32_t i = 0; i < BIQUAD_COEFF_NUM*Stage_Num; i++)
+	{
+		float32_t Scaled = p_Coeffs[i]*(float32_t)(1UL << (31 - BIQUAD_Q31_POST_SHIFT));
 		
-		for(uint32_t i = 0;i<Buff_Size;i++)
+		if((Scaled >= 2147483647.0f) || (Scaled < -2147483648.0f))
 		{
-			power = (*(p_SrcBuff+i))*(*(p_SrcBuff+i)) + power;
+			return ret= (t_FuncRet)Operation_Fail;
 		}
-		
-		*p_Result = sqrt(power/Buff_Size);
+		p_Cascade->Coeffs[i] = (int32_t)((Scaled >= 0) ? (Scaled + 0.5f) : (Scaled - 0.5f));
+	}
+	for(uint32_t i = 0; i < 4*Stage_Num; i++)
+	{
+		p_Cascade->State[i] = 0;
+	}
+	p_Cascade->Stage_Num = Stage_Num;
 	
-	#endif
+	return ret;
 }
 
 /** 
-* @description: Gets the Standard deviation of the array
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t*} p_Result   : the Standard deviation of squares of array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: Filter a block of samples by the Q31 biquad cascade, the state goes on across blocks.
+*				The 5 products are summed in 64 bits and shifted back by 31 - BIQUAD_Q31_POST_SHIFT,
+*				the same result as arm_biquad_cascade_df1_q31
+* @param  {Biquad_Cascade_Q31*} p_Cascade  : Biquad cascade structure pointer
+* @param  {int32_t*}            p_SrcBuff  : Input block, Q31
+* @param  {int32_t*}            p_DstBuff  : Output block, Q31, it can be the input block
+* @param  {uint32_t}            Block_Size : Number of samples
+* @return {void} 
 * @author: leeqingshui 
 */
-void Get_DataBuff_Std(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+void Biquad_Cascade_Process_Q31(Biquad_Cascade_Q31* p_Cascade, const int32_t* p_SrcBuff, int32_t* p_DstBuff, uint32_t Block_Size)
 {
-	#if(_DSP_STD_USED == 1)
-		arm_std_f32(p_SrcBuff, Buff_Size, p_Result);	
-	
+	#if(_DSP_BIQUAD_USED == 1)
+		arm_biquad_casd_df1_inst_q31 S = {p_Cascade->Stage_Num, p_Cascade->State, p_Cascade->Coeffs, BIQUAD_Q31_POST_SHIFT};
+		
+		arm_biquad_cascade_df1_q31(&S, (q31_t*)p_SrcBuff, p_DstBuff, Block_Size);
 	#else
-		float sumOfSquares = 0;
-		float sum		   = 0;
+		const int32_t* p_In = p_SrcBuff;
 		
-		for(uint32_t i = 0;i<Buff_Size;i++)
+		for(uint8_t stage = 0; stage < p_Cascade->Stage_Num; stage++)
 		{
-			sum = *(p_SrcBuff+i) + sum;
+			const int32_t* p_Coeffs = &p_Cascade->Coeffs[BIQUAD_COEFF_NUM*stage];
+			int32_t*       p_State  = &p_Cascade->State[4*stage];
+			int32_t x1 = p_State[0], x2 = p_State[1], y1 = p_State[2], y2 = p_State[3];
+			
+			for(uint32_t i = 0; i < Block_Size; i++)
+			{
+				int32_t x   = p_In[i];
+				int64_t acc = (int64_t)p_Coeffs[0]*x  + (int64_t)p_Coeffs[1]*x1 + (int64_t)p_Coeffs[2]*x2
+				            + (int64_t)p_Coeffs[3]*y1 + (int64_t)p_Coeffs[4]*y2;
+				int32_t y   = (int32_t)(acc >> (31 - BIQUAD_Q31_POST_SHIFT));
+				
+				x2 = x1;
+				x1 = x;
+				y2 = y1;
+				y1 = y;
+				p_DstBuff[i] = y;
+			}
+			
+			p_State[0] = x1;
+			p_State[1] = x2;
+			p_State[2] = y1;
+			p_State[3] = y2;
+			
+			/* The next stage filters the output of this one */
+			p_In = p_DstBuff;
 		}
-		
-		Get_DataBuff_Power(p_SrcBuff, Buff_Size, (float32_t*)&sumOfSquares);
-		
-		*p_Result = sqrt((sumOfSquares - (sum*sum/Buff_Size))/(Buff_Size - 1));
-	
 	#endif
 }
 
 /** 
-* @description: Get the array variance
-* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
-* @param  {float32_t*} p_Result   : the variance of squares of array
-* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
-* @return {void}                         
+* @description: Choose the bins of the sliding DFT bank and clear its history.
+*				Every frequency is rounded to the nearest bin k*Sample_Rate/Window, the bins settle after Window samples.
+*				The bank is refused if two frequencies fall into the same bin
+* @param  {Sliding_DFT_Bank*} p_Bank      : Sliding DFT bank
+* @param  {uint16_t}          Window      : DFT length N, 2 - SLIDING_DFT_WINDOW_MAX, the bin spacing is Sample_Rate/N
+* @param  {float32_t}         Sample_Rate : Sampling rate, unit: Hz
+* @param  {float32_t*}        p_Freq      : Frequency of every bin, between 0 and Sample_Rate/2 exclusive, unit: Hz
+* @param  {uint8_t}           Bin_Num     : Number of bins, 1 - SLIDING_DFT_BIN_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
 * @author: leeqingshui 
 */
-void Get_DataBuff_Var(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+t_FuncRet Sliding_DFT_Bank_Init(Sliding_DFT_Bank* p_Bank, uint16_t Window, float32_t Sample_Rate, const float32_t* p_Freq, uint8_t Bin_Num)
 {
-	#if(_DSP_VAR_USED == 1)
-		arm_var_f32(p_SrcBuff, Buff_Size, p_Result);	
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	#else
-		float meanOfElements = 0;
-		float sum		   = 0;
-		
-		Get_DataBuff_Std(p_SrcBuff, Buff_Size, (float32_t*)&meanOfElements);
+	if((p_Bank == NULL) || (p_Freq == NULL) || (Window < 2) || (Window > SLIDING_DFT_WINDOW_MAX) || 
+	   (Sample_Rate <= 0) || (Bin_Num == 0) || (Bin_Num > SLIDING_DFT_BIN_MAX))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
 	
-		for(uint32_t i = 0;i<Buff_Size;i++)
+	for(uint8_t b = 0; b < Bin_Num; b++)
+	{
+		uint16_t k = (uint16_t)(p_Freq[b]*Window/Sample_Rate + 0.5f);
+		
+		/* DC and Nyquist have no complex partner, they are not tracked */
+		if((k == 0) || (2*k >= Window))
 		{
-			sum = (*(p_SrcBuff+i) - meanOfElements)*(*(p_SrcBuff+i) - meanOfElements) + sum;
+			return ret= (t_FuncRet)Operation_Fail;
+		}
+		
+		/* Two frequencies rounded to the same bin could not be told apart */
+		for(uint8_t j = 0; j < b; j++)
+		{
+			if(p_Bank->Bin_Index[j] == k)
+			{
+				return ret= (t_FuncRet)Operation_Fail;
+			}
 		}
 		
-		*p_Result = sum/(Buff_Size);
+		p_Bank->Bin_Index[b] = k;
+		p_Bank->Cos[b]       = SLIDING_DFT_DAMPING*cosf(2*DSP_PI*k/Window);
+		p_Bank->Sin[b]       = SLIDING_DFT_DAMPING*sinf(2*DSP_PI*k/Window);
+		p_Bank->Re[b]        = 0;
+		p_Bank->Im[b]        = 0;
+	}
 	
-	#endif
+	memset(p_Bank->History, 0, sizeof(p_Bank->History));
+	
+	p_Bank->Damping_N = powf(SLIDING_DFT_DAMPING, Window);
+	p_Bank->Window    = Window;
+	p_Bank->Index     = 0;
+	p_Bank->Bin_Num   = Bin_Num;
+	
+	return ret;
 }
 
-/* Functions for testing digital signals */
-void DigtalSignal_Process_Test(void)
+/** 
+* @description: Update every bin of the sliding DFT bank with a block of samples, the state goes on across blocks
+* @param  {Sliding_DFT_Bank*} p_Bank     : Sliding DFT bank
+* @param  {float32_t*}        p_SrcBuff  : Input block
+* @param  {uint32_t}          Block_Size : Number of samples
+* @return {void} 
+* @author: leeqingshui 
+*/
+void Sliding_DFT_Bank_Process(Sliding_DFT_Bank* p_Bank, const float32_t* p_SrcBuff, uint32_t Block_Size)
 {
-	volatile static float32_t Result = 0;
-	volatile static uint32_t  Index  = 0;
+	for(uint32_t i = 0; i < Block_Size; i++)
+	{
+		DSP_Sliding_DFT_Update(p_Bank, p_SrcBuff[i]);
+	}
+}
+
+/** 
+* @description: Update every bin of the sliding DFT bank with a block of uint16_t samples, such as an ADC channel view
+* @param  {Sliding_DFT_Bank*} p_Bank     : Sliding DFT bank
+* @param  {uint16_t*}         p_SrcBuff  : Input block
+* @param  {uint32_t}          Stride     : Distance between two samples of the input, unit: uint16_t
+* @param  {uint32_t}          Block_Size : Number of samples
+* @return {void} 
+* @author: leeqingshui 
+*/
+void Sliding_DFT_Bank_Process_U16(Sliding_DFT_Bank* p_Bank, const uint16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size)
+{
+	for(uint32_t i = 0; i < Block_Size; i++)
+	{
+		DSP_Sliding_DFT_Update(p_Bank, (float32_t)p_SrcBuff[i*Stride]);
+	}
+}
+
+/** 
+* @description: Get the amplitude of the sinusoid in every bin of the sliding DFT bank, 2*|S|/N
+* @param  {Sliding_DFT_Bank*} p_Bank      : Sliding DFT bank
+* @param  {float32_t*}        p_Magnitude : Amplitude of every bin, Bin_Num values, unit: unit of the input
+* @return {void} 
+* @author: leeqingshui 
+*/
+void Sliding_DFT_Bank_Get_Magnitude(const Sliding_DFT_Bank* p_Bank, float32_t* p_Magnitude)
+{
+	float32_t Scale = 2.0f/p_Bank->Window;
+	
+	for(uint8_t b = 0; b < p_Bank->Bin_Num; b++)
+	{
+		p_Magnitude[b] = Scale*sqrtf(p_Bank->Re[b]*p_Bank->Re[b] + p_Bank->Im[b]*p_Bank->Im[b]);
+	}
+}
+
+/** 
+* @description: Prepare the EMG linear envelope filter: baseline removal, full wave rectification,
+*				2nd order Butterworth low pass and decimation, and clear its state
+* @param  {Envelope_Filter*} p_Filter    : Envelope filter
+* @param  {float32_t}        Sample_Rate : Sampling rate of the input, unit: Hz
+* @param  {float32_t}        Cutoff_Hz   : Low pass cutoff, below half of the output rate, unit: Hz
+* @param  {float32_t}        Baseline_Hz : Corner of the baseline tracking (the DC offset is removed below it), unit: Hz
+* @param  {uint16_t}         Decimation  : One output every Decimation input samples, at least 1
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Envelope_Filter_Init(Envelope_Filter* p_Filter, float32_t Sample_Rate, float32_t Cutoff_Hz, float32_t Baseline_Hz, uint16_t Decimation)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((p_Filter == NULL) || (Decimation == 0) || (Baseline_Hz <= 0) || (Cutoff_Hz*2*Decimation >= Sample_Rate))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	ret = Biquad_Design(BIQUAD_LOWPASS, Sample_Rate, Cutoff_Hz, 0.7071f, p_Filter->Coeffs);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	
+	p_Filter->State[0]       = 0;
+	p_Filter->State[1]       = 0;
+	p_Filter->Baseline       = 0;
+	p_Filter->Baseline_Alpha = 1.0f - expf(-2*DSP_PI*Baseline_Hz/Sample_Rate);
+	p_Filter->Baseline_Valid = (bool)FALSE;
+	p_Filter->Decimation     = Decimation;
+	p_Filter->Phase          = 0;
+	
+	return ret;
 }
 
+/** 
+* @description: Filter a block of uint16_t samples (such as an ADC channel view) into the decimated envelope.
+*				Every sample is read once and every stage runs in the same loop, nothing is written in between.
+*				The state and the decimation phase go on across blocks
+* @param  {Envelope_Filter*} p_Filter   : Envelope filter
+* @param  {uint16_t*}        p_SrcBuff  : Input block
+* @param  {uint32_t}         Stride     : Distance between two samples of the input, unit: uint16_t
+* @param  {uint32_t}         Block_Size : Number of input samples
+* @param  {float32_t*}       p_DstBuff  : Envelope, Block_Size/Decimation + 1 samples at most
+* @return {uint32_t}                    : Number of envelope samples written
+* @author: leeqingshui 
+*/
+uint32_t Envelope_Filter_Process_U16(Envelope_Filter* p_Filter, const uint16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, float32_t* p_DstBuff)
+{
+	float32_t b0 = p_Filter->Coeffs[0], b1 = p_Filter->Coeffs[1], b2 = p_Filter->Coeffs[2];
+	float32_t a1 = p_Filter->Coeffs[3], a2 = p_Filter->Coeffs[4];
+	float32_t d1 = p_Filter->State[0];
+	float32_t d2 = p_Filter->State[1];
+	float32_t Baseline = p_Filter->Baseline;
+	float32_t Alpha    = p_Filter->Baseline_Alpha;
+	uint16_t  Phase    = p_Filter->Phase;
+	uint32_t  Out_Num  = 0;
+	
+	/* The baseline starts at the first sample instead of settling from 0 */
+	if((p_Filter->Baseline_Valid == (bool)FALSE) && (Block_Size > 0))
+	{
+		Baseline = (float32_t)p_SrcBuff[0];
+		p_Filter->Baseline_Valid = (bool)TRUE;
+	}
+	
+	for(uint32_t i = 0; i < Block_Size; i++)
+	{
+		float32_t x = (float32_t)p_SrcBuff[i*Stride] - Baseline;
+		float32_t y;
+		
+		Baseline = Baseline + Alpha*x;
+		x        = fabsf(x);
+		
+		y  = b0*x + d1;
+		d1 = b1*x + a1*y + d2;
+		d2 = b2*x + a2*y;
+		
+		if(++Phase >= p_Filter->Decimation)
+		{
+			Phase = 0;
+			p_DstBuff[Out_Num++] = y;
+		}
+	}
+	
+	p_Filter->State[0] = d1;
+	p_Filter->State[1] = d2;
+	p_Filter->Baseline = Baseline;
+	p_Filter->Phase    = Phase;
+	
+	return Out_Num;
+}
+
+
+/** 
+* @description: Design the anti-aliasing / anti-imaging low pass of a polyphase resampler (windowed sinc, Hamming).
+*				The cutoff is 0.9 times the lower of the input and output Nyquist frequencies, every phase has a DC gain of 1.
+*				The coefficients are written phase by phase, each phase reversed, the order Polyphase_FIR_Process_F reads them
+* @param  {uint8_t}    Interpolation : Up sampling factor L, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint8_t}    Decimation    : Down sampling factor M, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint16_t}   Phase_Taps    : Taps of every phase, the prototype has Interpolation*Phase_Taps taps
+* @param  {float32_t*} p_Coeffs      : Coefficients, Interpolation*Phase_Taps values
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Polyphase_FIR_Design(uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, float32_t* p_Coeffs)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	float32_t Cutoff, Gain = 0;
+	uint32_t  Tap_Num;
+	
+	if((p_Coeffs == NULL) || !IS_POLYPHASE_FACTOR(Interpolation) || !IS_POLYPHASE_FACTOR(Decimation) || (Phase_Taps == 0))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	Tap_Num = (uint32_t)Interpolation*Phase_Taps;
+	Cutoff  = 0.45f/(float32_t)((Interpolation > Decimation) ? Interpolation : Decimation);
+	
+	for(uint32_t i = 0; i < Tap_Num; i++)
+	{
+		Gain = Gain + DSP_Polyphase_Tap(i, Tap_Num, Cutoff);
+	}
+	Gain = (float32_t)Interpolation/Gain;
+	
+	for(uint16_t phase = 0; phase < Interpolation; phase++)
+	{
+		for(uint16_t j = 0; j < Phase_Taps; j++)
+		{
+			p_Coeffs[phase*Phase_Taps + j] = Gain*DSP_Polyphase_Tap(phase + (uint32_t)(Phase_Taps - 1 - j)*Interpolation, Tap_Num, Cutoff);
+		}
+	}
+	
+	return ret;
+}
+
+/** 
+* @description: Design the polyphase resampler low pass in Q15, the same response as Polyphase_FIR_Design
+* @param  {uint8_t}    Interpolation : Up sampling factor L, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint8_t}    Decimation    : Down sampling factor M, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint16_t}   Phase_Taps    : Taps of every phase, the prototype has Interpolation*Phase_Taps taps
+* @param  {int16_t*}   p_Coeffs      : Coefficients, Q15, Interpolation*Phase_Taps values
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Polyphase_FIR_Design_Q15(uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, int16_t* p_Coeffs)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	float32_t Cutoff, Gain = 0;
+	uint32_t  Tap_Num;
+	
+	if((p_Coeffs == NULL) || !IS_POLYPHASE_FACTOR(Interpolation) || !IS_POLYPHASE_FACTOR(Decimation) || (Phase_Taps == 0))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	Tap_Num = (uint32_t)Interpolation*Phase_Taps;
+	Cutoff  = 0.45f/(float32_t)((Interpolation > Decimation) ? Interpolation : Decimation);
+	
+	for(uint32_t i = 0; i < Tap_Num; i++)
+	{
+		Gain = Gain + DSP_Polyphase_Tap(i, Tap_Num, Cutoff);
+	}
+	Gain = 32768.0f*(float32_t)Interpolation/Gain;
+	
+	for(uint16_t phase = 0; phase < Interpolation; phase++)
+	{
+		for(uint16_t j = 0; j < Phase_Taps; j++)
+		{
+			float32_t Tap = Gain*DSP_Polyphase_Tap(phase + (uint32_t)(Phase_Taps - 1 - j)*Interpolation, Tap_Num, Cutoff);
+			
+			/* The centre tap of an interpolator is 1.0, one LSB below it is kept */
+			p_Coeffs[phase*Phase_Taps + j] = (int16_t)__SSAT((int32_t)((Tap >= 0) ? (Tap + 0.5f) : (Tap - 0.5f)), 16);
+		}
+	}
+	
+	return ret;
+}
+
+/** 
+* @description: Prepare a floating point polyphase resampler, the output rate is Interpolation/Decimation times the input rate.
+*				The coefficients and the state are owned by the caller, so channels with the same rates share one coefficient set
+* @param  {Polyphase_FIR_F*} p_Resampler   : Resampler structure pointer
+* @param  {uint8_t}          Interpolation : Up sampling factor L, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint8_t}          Decimation    : Down sampling factor M, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint16_t}         Phase_Taps    : Taps of every phase
+* @param  {float32_t*}       p_Coeffs      : Coefficients from Polyphase_FIR_Design, Interpolation*Phase_Taps values
+* @param  {float32_t*}       p_State       : Delay line, 2*Phase_Taps values, cleared here
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Polyphase_FIR_Init_F(Polyphase_FIR_F* p_Resampler, uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, 
+							   const float32_t* p_Coeffs, float32_t* p_State)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((p_Resampler == NULL) || (p_Coeffs == NULL) || (p_State == NULL) || (Phase_Taps == 0) ||
+	   !IS_POLYPHASE_FACTOR(Interpolation) || !IS_POLYPHASE_FACTOR(Decimation))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	for(uint32_t i = 0; i < 2*(uint32_t)Phase_Taps; i++)
+	{
+		p_State[i] = 0;
+	}
+	p_Resampler->p_Coeffs      = p_Coeffs;
+	p_Resampler->p_State       = p_State;
+	p_Resampler->Phase_Taps    = Phase_Taps;
+	p_Resampler->Index         = 0;
+	p_Resampler->Interpolation = Interpolation;
+	p_Resampler->Decimation    = Decimation;
+	p_Resampler->Phase         = 0;
+	
+	return ret;
+}
+
+/** 
+* @description: Resample a block of samples, the state and the phase go on across blocks.
+*				Only the phases that fall on an output sample are computed, each one a contiguous dot product
+* @param  {Polyphase_FIR_F*} p_Resampler : Resampler structure pointer
+* @param  {float32_t*}       p_SrcBuff   : Input block
+* @param  {uint32_t}         Stride      : Distance between two samples of the input, unit: float32_t
+* @param  {uint32_t}         Block_Size  : Number of input samples
+* @param  {float32_t*}       p_DstBuff   : Output block, Block_Size*Interpolation/Decimation + 1 samples at most
+* @return {uint32_t}                     : Number of output samples written
+* @author: leeqingshui 
+*/
+uint32_t Polyphase_FIR_Process_F(Polyphase_FIR_F* p_Resampler, const float32_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, float32_t* p_DstBuff)
+{
+	uint16_t   Taps    = p_Resampler->Phase_Taps;
+	float32_t* p_State = p_Resampler->p_State;
+	uint16_t   Index   = p_Resampler->Index;
+	uint16_t   Phase   = p_Resampler->Phase;
+	uint32_t   Out_Num = 0;
+	
+	for(uint32_t i = 0; i < Block_Size; i++)
+	{
+		/* The delay line is written twice, so the last Taps samples are always contiguous: oldest first */
+		p_State[Index]        = p_SrcBuff[i*Stride];
+		p_State[Index + Taps] = p_SrcBuff[i*Stride];
+		
+		while(Phase < p_Resampler->Interpolation)
+		{
+			const float32_t* p_Coeffs = &p_Resampler->p_Coeffs[(uint32_t)Phase*Taps];
+			const float32_t* p_In     = &p_State[Index + 1];
+			float32_t        acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+			uint16_t         j    = 0;
+			
+			for(; j + 4 <= Taps; j += 4)
+			{
+				acc0 = acc0 + p_Coeffs[j]*p_In[j];
+				acc1 = acc1 + p_Coeffs[j + 1]*p_In[j + 1];
+				acc2 = acc2 + p_Coeffs[j + 2]*p_In[j + 2];
+				acc3 = acc3 + p_Coeffs[j + 3]*p_In[j + 3];
+			}
+			for(; j < Taps; j++)
+			{
+				acc0 = acc0 + p_Coeffs[j]*p_In[j];
+			}
+			
+			p_DstBuff[Out_Num++] = (acc0 + acc1) + (acc2 + acc3);
+			Phase = Phase + p_Resampler->Decimation;
+		}
+		Phase = Phase - p_Resampler->Interpolation;
+		
+		if(++Index >= Taps)
+		{
+			Index = 0;
+		}
+	}
+	
+	p_Resampler->Index = Index;
+	p_Resampler->Phase = Phase;
+	
+	return Out_Num;
+}
+
+/** 
+* @description: Prepare a Q15 polyphase resampler, the output rate is Interpolation/Decimation times the input rate
+* @param  {Polyphase_FIR_Q15*} p_Resampler   : Resampler structure pointer
+* @param  {uint8_t}            Interpolation : Up sampling factor L, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint8_t}            Decimation    : Down sampling factor M, 1 - POLYPHASE_FACTOR_MAX
+* @param  {uint16_t}           Phase_Taps    : Taps of every phase
+* @param  {int16_t*}           p_Coeffs      : Coefficients from Polyphase_FIR_Design_Q15, Interpolation*Phase_Taps values
+* @param  {int16_t*}           p_State       : Delay line, 2*Phase_Taps values, cleared here
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Polyphase_FIR_Init_Q15(Polyphase_FIR_Q15* p_Resampler, uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, 
+								 const int16_t* p_Coeffs, int16_t* p_State)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if((p_Resampler == NULL) || (p_Coeffs == NULL) || (p_State == NULL) || (Phase_Taps == 0) ||
+	   !IS_POLYPHASE_FACTOR(Interpolation) || !IS_POLYPHASE_FACTOR(Decimation))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	for(uint32_t i = 0; i < 2*(uint32_t)Phase_Taps; i++)
+	{
+		p_State[i] = 0;
+	}
+	p_Resampler->p_Coeffs      = p_Coeffs;
+	p_Resampler->p_State       = p_State;
+	p_Resampler->Phase_Taps    = Phase_Taps;
+	p_Resampler->Index         = 0;
+	p_Resampler->Interpolation = Interpolation;
+	p_Resampler->Decimation    = Decimation;
+	p_Resampler->Phase         = 0;
+	
+	return ret;
+}
+
+/** 
+* @description: Resample a block of Q15 samples, the state and the phase go on across blocks.
+*				Two taps per __SMLALD into a 64 bits accumulator, the result is rounded and saturated to 16 bits
+* @param  {Polyphase_FIR_Q15*} p_Resampler : Resampler structure pointer
+* @param  {int16_t*}           p_SrcBuff   : Input block
+* @param  {uint32_t}           Stride      : Distance between two samples of the input, unit: int16_t
+* @param  {uint32_t}           Block_Size  : Number of input samples
+* @param  {int16_t*}           p_DstBuff   : Output block, Block_Size*Interpolation/Decimation + 1 samples at most
+* @return {uint32_t}                       : Number of output samples written
+* @author: leeqingshui 
+*/
+uint32_t Polyphase_FIR_Process_Q15(Polyphase_FIR_Q15* p_Resampler, const int16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, int16_t* p_DstBuff)
+{
+	uint16_t Taps    = p_Resampler->Phase_Taps;
+	int16_t* p_State = p_Resampler->p_State;
+	uint16_t Index   = p_Resampler->Index;
+	uint16_t Phase   = p_Resampler->Phase;
+	uint32_t Out_Num = 0;
+	
+	for(uint32_t i = 0; i < Block_Size; i++)
+	{
+		p_State[Index]        = p_SrcBuff[i*Stride];
+		p_State[Index + Taps] = p_SrcBuff[i*Stride];
+		
+		while(Phase < p_Resampler->Interpolation)
+		{
+			const int16_t* p_Coeffs = &p_Resampler->p_Coeffs[(uint32_t)Phase*Taps];
+			const int16_t* p_In     = &p_State[Index + 1];
+			int64_t        acc      = 1 << 14;
+			uint32_t       c, x;
+			uint16_t       j        = 0;
+			
+			/* The delay line start moves by one sample, so the pairs are loaded without an alignment assumption */
+			for(; j + 2 <= Taps; j += 2)
+			{
+				memcpy(&c, &p_Coeffs[j], sizeof(c));
+				memcpy(&x, &p_In[j], sizeof(x));
+				acc = (int64_t)__SMLALD(c, x, (uint64_t)acc);
+			}
+			if(j < Taps)
+			{
+				acc = acc + (int32_t)p_Coeffs[j]*p_In[j];
+			}
+			
+			p_DstBuff[Out_Num++] = (int16_t)__SSAT((int32_t)(acc >> 15), 16);
+			Phase = Phase + p_Resampler->Decimation;
+		}
+		Phase = Phase - p_Resampler->Interpolation;
+		
+		if(++Index >= Taps)
+		{
+			Index = 0;
+		}
+	}
+	
+	p_Resampler->Index = Index;
+	p_Resampler->Phase = Phase;
+	
+	return Out_Num;
+}
+
+/** 
+* @description: Get the absolute value of an array
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t*} p_DstpBuff : A pointer to the processed array
+* @param  {uint32_t}   Buff_Size  : Number of elements (not bytes) of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Abs(float32_t* p_SrcBuff,float32_t* p_DstpBuff,uint32_t Buff_Size)
+{	
+	#if(_DSP_ABS_USED == 1)
+		arm_abs_f32(p_SrcBuff,p_DstpBuff,Buff_Size);
+	#else
+		uint32_t Block_Num  = Buff_Size >> 2;
+		uint32_t Remain_Num = Buff_Size & 0x3;
+		
+		/* Four samples per loop to reduce the loop overhead */
+		while(Block_Num > 0)
+		{
+			p_DstpBuff[0] = fabsf(p_SrcBuff[0]);
+			p_DstpBuff[1] = fabsf(p_SrcBuff[1]);
+			p_DstpBuff[2] = fabsf(p_SrcBuff[2]);
+			p_DstpBuff[3] = fabsf(p_SrcBuff[3]);
+			
+			p_SrcBuff  = p_SrcBuff  + 4;
+			p_DstpBuff = p_DstpBuff + 4;
+			Block_Num--;
+		}
+		
+		while(Remain_Num > 0)
+		{
+			*p_DstpBuff++ = fabsf(*p_SrcBuff++);
+			Remain_Num--;
+		}
+	#endif
+}
+
+/** 
+* @description: Get the absolute value of a Q15 array, -32768 saturates to 32767.
+*				Two samples are read with one word access, the array only needs halfword alignment
+* @param  {int16_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {int16_t*} p_DstpBuff : A pointer to the processed array, it can be the source array
+* @param  {uint32_t} Buff_Size  : Number of elements (not bytes) of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Abs_Q15(int16_t* p_SrcBuff, int16_t* p_DstpBuff, uint32_t Buff_Size)
+{
+	#if(_DSP_ABS_USED == 1)
+		arm_abs_q15((q15_t*)p_SrcBuff, (q15_t*)p_DstpBuff, Buff_Size);
+	#else
+		uint32_t Block_Num  = Buff_Size >> 2;
+		uint32_t Remain_Num = Buff_Size & 0x3;
+		uint32_t in[2], neg[2];
+		
+		/* Four samples (two packed pairs) per loop, both halves are negated by one saturating subtraction */
+		while(Block_Num > 0)
+		{
+			memcpy(in, p_SrcBuff, sizeof(in));
+			
+			neg[0] = __QSUB16(0, in[0]);
+			neg[1] = __QSUB16(0, in[1]);
+			
+			in[0] = ((in[0] & 0x80000000U) ? (neg[0] & 0xFFFF0000U) : (in[0] & 0xFFFF0000U)) | 
+			        ((in[0] & 0x00008000U) ? (neg[0] & 0x0000FFFFU) : (in[0] & 0x0000FFFFU));
+			in[1] = ((in[1] & 0x80000000U) ? (neg[1] & 0xFFFF0000U) : (in[1] & 0xFFFF0000U)) | 
+			        ((in[1] & 0x00008000U) ? (neg[1] & 0x0000FFFFU) : (in[1] & 0x0000FFFFU));
+			
+			memcpy(p_DstpBuff, in, sizeof(in));
+			
+			p_SrcBuff  = p_SrcBuff  + 4;
+			p_DstpBuff = p_DstpBuff + 4;
+			Block_Num--;
+		}
+		
+		while(Remain_Num > 0)
+		{
+			int16_t temp = *p_SrcBuff++;
+			
+			*p_DstpBuff++ = (temp < 0) ? (int16_t)__SSAT(-(int32_t)temp, 16) : temp;
+			Remain_Num--;
+		}
+	#endif
+}
+
+/** 
+* @description: Get the offset additioned value of an array
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t}  offset     : Data offset
+* @param  {float32_t*} p_DstpBuff : A pointer to the processed array
+* @param  {uint32_t}   Buff_Size  : Number of elements (not bytes) of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Offeset(float32_t* p_SrcBuff, float32_t offset,float32_t* p_DstpBuff,uint32_t Buff_Size)
+{
+	#if(_DSP_OFFSET_USED == 1)
+		arm_offset_f32(p_SrcBuff, offset, p_DstpBuff, Buff_Size);	
+
+	#else
+		uint32_t Block_Num  = Buff_Size >> 2;
+		uint32_t Remain_Num = Buff_Size & 0x3;
+		
+		/* Four samples per loop to reduce the loop overhead */
+		while(Block_Num > 0)
+		{
+			p_DstpBuff[0] = p_SrcBuff[0] + offset;
+			p_DstpBuff[1] = p_SrcBuff[1] + offset;
+			p_DstpBuff[2] = p_SrcBuff[2] + offset;
+			p_DstpBuff[3] = p_SrcBuff[3] + offset;
+			
+			p_SrcBuff  = p_SrcBuff  + 4;
+			p_DstpBuff = p_DstpBuff + 4;
+			Block_Num--;
+		}
+		
+		while(Remain_Num > 0)
+		{
+			*p_DstpBuff++ = *p_SrcBuff++ + offset;
+			Remain_Num--;
+		}
+	
+	#endif
+}
+
+/** 
+* @description: Get the offset additioned value of a Q15 array, saturated to Q15.
+*				Two samples are added with one __QADD16, the array only needs halfword alignment
+* @param  {int16_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {int16_t}  offset     : Data offset, Q15
+* @param  {int16_t*} p_DstpBuff : A pointer to the processed array, it can be the source array
+* @param  {uint32_t} Buff_Size  : Number of elements (not bytes) of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Offeset_Q15(int16_t* p_SrcBuff, int16_t offset, int16_t* p_DstpBuff, uint32_t Buff_Size)
+{
+	#if(_DSP_OFFSET_USED == 1)
+		arm_offset_q15((q15_t*)p_SrcBuff, (q15_t)offset, (q15_t*)p_DstpBuff, Buff_Size);
+	
+	#else
+		uint32_t Block_Num  = Buff_Size >> 2;
+		uint32_t Remain_Num = Buff_Size & 0x3;
+		uint32_t Offset_Packed = __PKHBT((uint32_t)(uint16_t)offset, (uint32_t)(uint16_t)offset, 16);
+		uint32_t in[2];
+		
+		/* Four samples (two packed pairs) per loop */
+		while(Block_Num > 0)
+		{
+			memcpy(in, p_SrcBuff, sizeof(in));
+			
+			in[0] = __QADD16(in[0], Offset_Packed);
+			in[1] = __QADD16(in[1], Offset_Packed);
+			
+			memcpy(p_DstpBuff, in, sizeof(in));
+			
+			p_SrcBuff  = p_SrcBuff  + 4;
+			p_DstpBuff = p_DstpBuff + 4;
+			Block_Num--;
+		}
+		
+		while(Remain_Num > 0)
+		{
+			*p_DstpBuff++ = (int16_t)__SSAT((int32_t)(*p_SrcBuff++) + offset, 16);
+			Remain_Num--;
+		}
+	
+	#endif
+}
+
+/** 
+* @description: Computes the maximum value of the data array. This function returns the maximum value and its position in the array
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}   Buff_Size  : Number of elements (not bytes) of Data Buffer
+* @param  {float32_t*} p_Result   : the maximum value of the data array
+* @param  {uint32_t*}  p_Index    : The maximum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Max(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result, uint32_t* p_Index)
+{
+	#if(_DSP_MAX_USED == 1)
+		arm_max_f32 (p_SrcBuff, Buff_Size, p_Result, p_Index);
+	
+	#else
+		// Assume that the first element in the array is the maximum value
+		float32_t temp_max = *p_SrcBuff;
+		uint32_t  temp_index = 0;
+		
+		// Go through the group, getting each element, ready to compare
+		for(uint32_t i = 1; i < Buff_Size; i++)
+		{
+			// If something larger than max occurs during the comparison, let max record the larger value
+			if((*(p_SrcBuff + i)) > temp_max)
+			{
+					temp_max = *(p_SrcBuff + i);
+					temp_index = i;
+			}
+		}
+		
+		// The loop ends and the result is retrieved
+		*p_Result = temp_max;
+		*p_Index  = temp_index;
+		
+	#endif
+}
+
+/** 
+* @description: Computes the maximum value of the data array. This function returns the maximum value and its position in the array
+* @param  {uint16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @param  {uint16_t*}  p_Result   : the maximum value of the data array
+* @param  {uint32_t*}  p_Index    : The maximum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Max_U16(uint16_t* p_SrcBuff, uint32_t Buff_Size, uint16_t* p_Result, uint32_t* p_Index)
+{
+    // Assume that the first element in the array is the maximum value
+    uint16_t  temp_max = *p_SrcBuff;
+    uint32_t  temp_index = 0;
+    
+    // Go through the group, getting each element, ready to compare
+    for(uint32_t i = 1; i < Buff_Size; i++)
+    {
+        // If something larger than max occurs during the comparison, let max record the larger value
+        if((*(p_SrcBuff + i)) > temp_max)
+        {
+                temp_max = *(p_SrcBuff + i);
+                temp_index = i;
+        }
+    }
+    
+    // The loop ends and the result is retrieved
+    *p_Result = temp_max;
+    *p_Index  = temp_index;
+}
+
+/** 
+* @description: The target array is multiplied by the proportionality constant
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t}  ratio      : the proportionality constant
+* @param  {float32_t*} p_DstpBuff : A pointer to the processed array
+* @param  {uint32_t}   Buff_Size  : Number of elements (not bytes) of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Scale(float32_t* p_SrcBuff, float32_t ratio,float32_t* p_DstpBuff,uint32_t Buff_Size)
+{
+	#if(_DSP_SCALE_USED == 1)
+		arm_scale_f32(p_SrcBuff, ratio, p_DstpBuff, Buff_Size);	
+	
+	#else
+		uint32_t Block_Num  = Buff_Size >> 2;
+		uint32_t Remain_Num = Buff_Size & 0x3;
+		
+		/* Four samples per loop to reduce the loop overhead */
+		while(Block_Num > 0)
+		{
+			p_DstpBuff[0] = p_SrcBuff[0]*ratio;
+			p_DstpBuff[1] = p_SrcBuff[1]*ratio;
+			p_DstpBuff[2] = p_SrcBuff[2]*ratio;
+			p_DstpBuff[3] = p_SrcBuff[3]*ratio;
+			
+			p_SrcBuff  = p_SrcBuff  + 4;
+			p_DstpBuff = p_DstpBuff + 4;
+			Block_Num--;
+		}
+		
+		while(Remain_Num > 0)
+		{
+			*p_DstpBuff++ = (*p_SrcBuff++)*ratio;
+			Remain_Num--;
+		}
+	
+	#endif
+}
+
+/** 
+* @description: The Q15 array is multiplied by a Q15 proportionality constant and shifted left,
+*				p_DstpBuff[n] = (p_SrcBuff[n]*Scale_Fract) >> (15 - Shift), saturated to Q15
+* @param  {int16_t*} p_SrcBuff   : A pointer to the array to be processed
+* @param  {int16_t}  Scale_Fract : Fractional part of the proportionality constant (Q15)
+* @param  {int8_t}   Shift       : Number of bits to shift the result left, 0 ~ 15
+* @param  {int16_t*} p_DstpBuff  : A pointer to the processed array
+* @param  {uint32_t} Buff_Size   : Size of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Scale_Q15(int16_t* p_SrcBuff, int16_t Scale_Fract, int8_t Shift, int16_t* p_DstpBuff, uint32_t Buff_Size)
+{
+	#if(_DSP_SCALE_USED == 1)
+		arm_scale_q15((q15_t*)p_SrcBuff, (q15_t)Scale_Fract, Shift, (q15_t*)p_DstpBuff, Buff_Size);
+	
+	#else
+		int32_t  Right_Shift = 15 - Shift;
+		uint32_t Block_Num   = Buff_Size >> 2;
+		uint32_t Remain_Num  = Buff_Size & 0x3;
+		int32_t  temp[4];
+		
+		/* Four samples per loop to reduce the loop overhead */
+		while(Block_Num > 0)
+		{
+			temp[0] = ((int32_t)p_SrcBuff[0]*Scale_Fract) >> Right_Shift;
+			temp[1] = ((int32_t)p_SrcBuff[1]*Scale_Fract) >> Right_Shift;
+			temp[2] = ((int32_t)p_SrcBuff[2]*Scale_Fract) >> Right_Shift;
+			temp[3] = ((int32_t)p_SrcBuff[3]*Scale_Fract) >> Right_Shift;
+			
+			p_DstpBuff[0] = (int16_t)__SSAT(temp[0], 16);
+			p_DstpBuff[1] = (int16_t)__SSAT(temp[1], 16);
+			p_DstpBuff[2] = (int16_t)__SSAT(temp[2], 16);
+			p_DstpBuff[3] = (int16_t)__SSAT(temp[3], 16);
+			
+			p_SrcBuff  = p_SrcBuff  + 4;
+			p_DstpBuff = p_DstpBuff + 4;
+			Block_Num--;
+		}
+		
+		while(Remain_Num > 0)
+		{
+			temp[0] = ((int32_t)(*p_SrcBuff++)*Scale_Fract) >> Right_Shift;
+			*p_DstpBuff++ = (int16_t)__SSAT(temp[0], 16);
+			Remain_Num--;
+		}
+	
+	#endif
+}
+
+/** 
+* @description: Get the array average
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t*} p_Result   : Average of array
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Mean(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+{
+	#if(_DSP_MEAN_USED == 1)
+		arm_mean_f32(p_SrcBuff, Buff_Size, p_Result);	
+	
+	#else
+		float sum = 0;
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			sum = sum + *(p_SrcBuff+i);
+		}
+		
+		*p_Result = sum/Buff_Size;
+	
+	#endif
+}
+
+/** 
+* @description: Get the array average
+* @param  {uint16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t*} p_Result   : Average of array
+* @param  {uint16_t*}  Buff_Size  : Size of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Mean_U16(uint16_t* p_SrcBuff, uint32_t Buff_Size, uint16_t* p_Result)
+{
+    uint32_t sum = 0;
+    
+    for(uint32_t i = 0;i<Buff_Size;i++)
+    {
+        sum = sum + *(p_SrcBuff+i);
+    }
+    
+    *p_Result = (uint16_t)sum/Buff_Size;
+}
+
+/** 
+* @description: Computes the minimum value of the data array. This function returns the minimum value and its position in the array
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @param  {float32_t*} p_Result   : the minimum value of the data array
+* @param  {uint32_t*}  p_Index    : The minimum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Min(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result, uint32_t* p_Index)
+{
+	#if(_DSP_MIN_USED == 1)
+		arm_min_f32 (p_SrcBuff, Buff_Size, p_Result, p_Index);
+	
+	#else
+		// Assume that the first element in the array is the maximum value
+		float32_t temp_min = *p_SrcBuff;
+		uint32_t  temp_index = 0;
+		
+		// Go through the group, getting each element, ready to compare
+		for(uint32_t i = 1; i < Buff_Size; i++)
+		{
+			// If something larger than max occurs during the comparison, let max record the larger value
+			if((*(p_SrcBuff + i)) < temp_min)
+			{
+					temp_min = *(p_SrcBuff + i);
+					temp_index = i;
+			}
+		}
+		
+		// The loop ends and the result is retrieved
+		*p_Result = temp_min;
+		*p_Index  = temp_index;
+		
+	#endif
+}
+
+/** 
+* @description: Computes the minimum value of the data array. This function returns the minimum value and its position in the array
+* @param  {uint16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @param  {uint16_t*}  p_Result   : the minimum value of the data array
+* @param  {uint32_t*}  p_Index    : The minimum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Min_U16(uint16_t* p_SrcBuff, uint32_t Buff_Size, uint16_t* p_Result, uint32_t* p_Index)
+{
+    // Assume that the first element in the array is the maximum value
+    uint16_t  temp_min = *p_SrcBuff;
+    uint32_t  temp_index = 0;
+    
+    // Go through the group, getting each element, ready to compare
+    for(uint32_t i = 1; i < Buff_Size; i++)
+    {
+        // If something larger than max occurs during the comparison, let max record the larger value
+        if((*(p_SrcBuff + i)) < temp_min)
+        {
+                temp_min = *(p_SrcBuff + i);
+                temp_index = i;
+        }
+    }
+    
+    // The loop ends and the result is retrieved
+    *p_Result = temp_min;
+    *p_Index  = temp_index;
+}
+
+/** 
+* @description: Gets the sum of squares in the array
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t*} p_Result   : the sum of squares of array
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Power(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+{
+	#if(_DSP_POWER_USED == 1)
+		arm_power_f32(p_SrcBuff, Buff_Size, p_Result);	
+	
+	#else
+		float power = 0;
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			power = (*(p_SrcBuff+i))*(*(p_SrcBuff+i)) + power;
+		}
+		
+		*p_Result = power;
+	
+	#endif
+}
+
+/** 
+* @description: Gets the Root Mean Sqaure of the array
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t*} p_Result   : the Root Mean Sqaure of squares of array
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Rms(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+{
+	#if(_DSP_RMS_USED == 1)
+		arm_rms_f32(p_SrcBuff, Buff_Size, p_Result);	
+	
+	#else
+		float power = 0;
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			power = (*(p_SrcBuff+i))*(*(p_SrcBuff+i)) + power;
+		}
+		
+		*p_Result = sqrt(power/Buff_Size);
+	
+	#endif
+}
+
+/** 
+* @description: Gets the Standard deviation of the array
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t*} p_Result   : the Standard deviation of squares of array
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Std(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+{
+	#if(_DSP_STD_USED == 1)
+		arm_std_f32(p_SrcBuff, Buff_Size, p_Result);	
+	
+	#else
+		float sumOfSquares = 0;
+		float sum		   = 0;
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			sum = *(p_SrcBuff+i) + sum;
+		}
+		
+		Get_DataBuff_Power(p_SrcBuff, Buff_Size, (float32_t*)&sumOfSquares);
+		
+		*p_Result = sqrt((sumOfSquares - (sum*sum/Buff_Size))/(Buff_Size - 1));
+	
+	#endif
+}
+
+/** 
+* @description: Get the array variance
+* @param  {float32_t*} p_SrcBuff  : A pointer to the array to be processed
+* @param  {float32_t*} p_Result   : the variance of squares of array
+* @param  {uint32_t}   Buff_Size  : Size of Data Buffer
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Var(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result)
+{
+	#if(_DSP_VAR_USED == 1)
+		arm_var_f32(p_SrcBuff, Buff_Size, p_Result);	
+	
+	#else
+		float meanOfElements = 0;
+		float sum		   = 0;
+		
+		if(Buff_Size < 2)
+		{
+			*p_Result = 0;
+			return;
+		}
+		
+		Get_DataBuff_Mean(p_SrcBuff, Buff_Size, (float32_t*)&meanOfElements);
+	
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			sum = (*(p_SrcBuff+i) - meanOfElements)*(*(p_SrcBuff+i) - meanOfElements) + sum;
+		}
+		
+		*p_Result = sum/(Buff_Size - 1);
+	
+	#endif
+}
+
+/** 
+* @description: Computes all the time domain statistics of the array in one pass.
+*				The sums are taken on the samples minus the first sample (shifted data), which keeps the
+*				variance accurate for a large DC offset like an ADC baseline without a division per sample
+* @param  {float32_t*}           p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}             Buff_Size  : Size of Data Buffer
+* @param  {DataBuff_Statistics*} p_Result   : Statistics of the array, Var and Std are 0 for a single sample
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Get_DataBuff_Statistics(float32_t* p_SrcBuff, uint32_t Buff_Size, DataBuff_Statistics* p_Result)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	float32_t shift       = 0;
+	float32_t sumShifted  = 0;
+	float32_t sumSqShifted= 0;
+	float32_t power       = 0;
+	float32_t temp_max    = 0;
+	float32_t temp_min    = 0;
+	uint32_t  max_index   = 0;
+	uint32_t  min_index   = 0;
+	
+	if((p_SrcBuff == NULL) || (p_Result == NULL) || (Buff_Size == 0))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	shift    = p_SrcBuff[0];
+	temp_max = p_SrcBuff[0];
+	temp_min = p_SrcBuff[0];
+	
+	for(uint32_t i = 0;i<Buff_Size;i++)
+	{
+		float32_t in    = p_SrcBuff[i];
+		float32_t delta = in - shift;
+		
+		sumShifted   = sumShifted + delta;
+		sumSqShifted = sumSqShifted + delta*delta;
+		power        = power + in*in;
+		
+		if(in > temp_max)
+		{
+			temp_max  = in;
+			max_index = i;
+		}
+		if(in < temp_min)
+		{
+			temp_min  = in;
+			min_index = i;
+		}
+	}
+	
+	p_Result->Mean  = shift + sumShifted/Buff_Size;
+	p_Result->Power = power;
+	p_Result->Rms   = sqrtf(power/Buff_Size);
+	
+	if(Buff_Size > 1)
+	{
+		p_Result->Var = (sumSqShifted - sumShifted*sumShifted/Buff_Size)/(Buff_Size - 1);
+		/* Rounding may leave a tiny negative number for a constant buffer */
+		if(p_Result->Var < 0)
+		{
+			p_Result->Var = 0;
+		}
+	}
+	else
+	{
+		p_Result->Var = 0;
+	}
+	p_Result->Std = sqrtf(p_Result->Var);
+	
+	p_Result->Max       = temp_max;
+	p_Result->Max_Index = max_index;
+	p_Result->Min       = temp_min;
+	p_Result->Min_Index = min_index;
+	
+	return ret;
+}
+
+/* ================================Fixed point (Q15 / Q31) statistics=============================== */
+
+/** 
+* @description: Get the array average, Q15. Raw ADC codes (0 - 4095) can be passed as they are
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int16_t*}  p_Result   : Average of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Mean_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result)
+{
+	#if(_DSP_MEAN_USED == 1)
+		arm_mean_q15((q15_t*)p_SrcBuff, Buff_Size, (q15_t*)p_Result);
+	
+	#else
+		int32_t  sum   = 0;
+		int64_t  sumSq = 0;
+		
+		DSP_Accumulate_Q15(p_SrcBuff, Buff_Size, &sum, &sumSq);
+		
+		*p_Result = (int16_t)(sum / (int32_t)Buff_Size);
+	
+	#endif
+}
+
+/** 
+* @description: Get the array average, Q31
+* @param  {int32_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int32_t*}  p_Result   : Average of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Mean_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result)
+{
+	#if(_DSP_MEAN_USED == 1)
+		arm_mean_q31((q31_t*)p_SrcBuff, Buff_Size, (q31_t*)p_Result);
+	
+	#else
+		int64_t sum = 0;
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			sum = sum + p_SrcBuff[i];
+		}
+		
+		*p_Result = (int32_t)(sum / (int32_t)Buff_Size);
+	
+	#endif
+}
+
+/** 
+* @description: Gets the sum of squares in the array, Q15. The result is in 34.30 format
+*				(for raw ADC codes it is the plain integer sum of squares)
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int64_t*}  p_Result   : the sum of squares of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Power_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int64_t* p_Result)
+{
+	#if(_DSP_POWER_USED == 1)
+		arm_power_q15((q15_t*)p_SrcBuff, Buff_Size, (q63_t*)p_Result);
+	
+	#else
+		int32_t  sum   = 0;
+		int64_t  sumSq = 0;
+		
+		DSP_Accumulate_Q15(p_SrcBuff, Buff_Size, &sum, &sumSq);
+		
+		*p_Result = sumSq;
+	
+	#endif
+}
+
+/** 
+* @description: Gets the sum of squares in the array, Q31. The result is in 16.48 format
+* @param  {int32_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int64_t*}  p_Result   : the sum of squares of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Power_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int64_t* p_Result)
+{
+	#if(_DSP_POWER_USED == 1)
+		arm_power_q31((q31_t*)p_SrcBuff, Buff_Size, (q63_t*)p_Result);
+	
+	#else
+		int64_t sumSq = 0;
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			sumSq = sumSq + (((int64_t)p_SrcBuff[i]*p_SrcBuff[i]) >> 14);
+		}
+		
+		*p_Result = sumSq;
+	
+	#endif
+}
+
+/** 
+* @description: Gets the Root Mean Sqaure of the array, Q15 (for raw ADC codes the result is in ADC codes).
+*				The root is taken of the Q30 mean of squares: arm_rms_q15 shifts it to Q15 first,
+*				which gives 0 for raw codes below 182
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int16_t*}  p_Result   : the Root Mean Sqaure of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Rms_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result)
+{
+	int32_t  sum   = 0;
+	int64_t  sumSq = 0;
+	uint32_t root  = 0;
+	
+	DSP_Accumulate_Q15(p_SrcBuff, Buff_Size, &sum, &sumSq);
+	
+	/* The root of a Q30 value is Q15 */
+	root      = DSP_Sqrt_U64((uint64_t)sumSq / Buff_Size);
+	*p_Result = (int16_t)((root > INT16_MAX) ? INT16_MAX : root);
+}
+
+/** 
+* @description: Gets the Root Mean Sqaure of the array, Q31
+* @param  {int32_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int32_t*}  p_Result   : the Root Mean Sqaure of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Rms_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result)
+{
+	#if(_DSP_RMS_USED == 1)
+		arm_rms_q31((q31_t*)p_SrcBuff, Buff_Size, (q31_t*)p_Result);
+	
+	#else
+		int64_t sumSq    = 0;
+		int64_t meanOfSq = 0;
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			sumSq = sumSq + (int64_t)p_SrcBuff[i]*p_SrcBuff[i];
+		}
+		
+		meanOfSq  = (sumSq / (int64_t)Buff_Size) >> 31;
+		*p_Result = DSP_Sqrt_Q31((meanOfSq > INT32_MAX) ? INT32_MAX : (int32_t)meanOfSq);
+	
+	#endif
+}
+
+/** 
+* @description: Gets the Standard deviation of the array, Q15 (for raw ADC codes the result is in ADC codes).
+*				The root is taken of the Q30 variance: arm_std_q15 shifts it to Q15 first,
+*				which gives 0 for raw codes below 182
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer, at least 2
+* @param  {int16_t*}  p_Result   : the Standard deviation of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Std_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result)
+{
+	int32_t  sum   = 0;
+	int64_t  sumSq = 0;
+	int64_t  var   = 0;
+	uint32_t root  = 0;
+	
+	if(Buff_Size < 2)
+	{
+		*p_Result = 0;
+		return;
+	}
+	
+	DSP_Accumulate_Q15(p_SrcBuff, Buff_Size, &sum, &sumSq);
+	
+	/* The root of a Q30 value is Q15 */
+	var       = DSP_Var_Q30(sum, sumSq, Buff_Size);
+	root      = (var > 0) ? DSP_Sqrt_U64((uint64_t)var) : 0;
+	*p_Result = (int16_t)((root > INT16_MAX) ? INT16_MAX : root);
+}
+
+/** 
+* @description: Gets the Standard deviation of the array, Q31
+* @param  {int32_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer, at least 2
+* @param  {int32_t*}  p_Result   : the Standard deviation of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Std_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result)
+{
+	#if(_DSP_STD_USED == 1)
+		arm_std_q31((q31_t*)p_SrcBuff, Buff_Size, (q31_t*)p_Result);
+	
+	#else
+		int32_t var = 0;
+		
+		Get_DataBuff_Var_Q31(p_SrcBuff, Buff_Size, &var);
+		
+		*p_Result = DSP_Sqrt_Q31(var);
+	
+	#endif
+}
+
+/** 
+* @description: Get the array variance, Q15 (as arm_var_q15). For raw ADC codes the result is the variance
+*				in codes^2 / 32768, rounded, so a spread below 128 codes reads 0: use Get_DataBuff_Std_Q15 there
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer, at least 2
+* @param  {int16_t*}  p_Result   : the variance of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Var_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result)
+{
+	#if(_DSP_VAR_USED == 1)
+		arm_var_q15((q15_t*)p_SrcBuff, Buff_Size, (q15_t*)p_Result);
+	
+	#else
+		int32_t  sum   = 0;
+		int64_t  sumSq = 0;
+		
+		if(Buff_Size < 2)
+		{
+			*p_Result = 0;
+			return;
+		}
+		
+		DSP_Accumulate_Q15(p_SrcBuff, Buff_Size, &sum, &sumSq);
+		
+		*p_Result = (int16_t)__SSAT((int32_t)((DSP_Var_Q30(sum, sumSq, Buff_Size) + (1 << 14)) >> 15), 16);
+	
+	#endif
+}
+
+/** 
+* @description: Get the array variance, Q31. The samples are reduced to Q23 before squaring, as arm_var_q31
+* @param  {int32_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer, at least 2
+* @param  {int32_t*}  p_Result   : the variance of array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Var_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result)
+{
+	#if(_DSP_VAR_USED == 1)
+		arm_var_q31((q31_t*)p_SrcBuff, Buff_Size, (q31_t*)p_Result);
+	
+	#else
+		int64_t sum   = 0;
+		int64_t sumSq = 0;
+		
+		if(Buff_Size < 2)
+		{
+			*p_Result = 0;
+			return;
+		}
+		
+		for(uint32_t i = 0;i<Buff_Size;i++)
+		{
+			int32_t in = p_SrcBuff[i] >> 8;
+			
+			sum   = sum + in;
+			sumSq = sumSq + (int64_t)in*in;
+		}
+		
+		*p_Result = (int32_t)(((sumSq / (int64_t)(Buff_Size - 1)) - (sum*sum / (int64_t)(Buff_Size*(Buff_Size - 1)))) >> 15);
+	
+	#endif
+}
+
+/** 
+* @description: Computes the maximum value of the data array, Q15. This function returns the maximum value and its position in the array
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int16_t*}  p_Result   : the maximum value of the data array
+* @param  {uint32_t*} p_Index    : The maximum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Max_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result, uint32_t* p_Index)
+{
+	#if(_DSP_MAX_USED == 1)
+		arm_max_q15((q15_t*)p_SrcBuff, Buff_Size, (q15_t*)p_Result, p_Index);
+	
+	#else
+		int16_t  temp_max   = p_SrcBuff[0];
+		uint32_t temp_index = 0;
+		
+		for(uint32_t i = 1; i < Buff_Size; i++)
+		{
+			if(p_SrcBuff[i] > temp_max)
+			{
+				temp_max   = p_SrcBuff[i];
+				temp_index = i;
+			}
+		}
+		
+		*p_Result = temp_max;
+		*p_Index  = temp_index;
+	
+	#endif
+}
+
+/** 
+* @description: Computes the maximum value of the data array, Q31. This function returns the maximum value and its position in the array
+* @param  {int32_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int32_t*}  p_Result   : the maximum value of the data array
+* @param  {uint32_t*} p_Index    : The maximum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Max_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result, uint32_t* p_Index)
+{
+	#if(_DSP_MAX_USED == 1)
+		arm_max_q31((q31_t*)p_SrcBuff, Buff_Size, (q31_t*)p_Result, p_Index);
+	
+	#else
+		int32_t  temp_max   = p_SrcBuff[0];
+		uint32_t temp_index = 0;
+		
+		for(uint32_t i = 1; i < Buff_Size; i++)
+		{
+			if(p_SrcBuff[i] > temp_max)
+			{
+				temp_max   = p_SrcBuff[i];
+				temp_index = i;
+			}
+		}
+		
+		*p_Result = temp_max;
+		*p_Index  = temp_index;
+	
+	#endif
+}
+
+/** 
+* @description: Computes the minimum value of the data array, Q15. This function returns the minimum value and its position in the array
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int16_t*}  p_Result   : the minimum value of the data array
+* @param  {uint32_t*} p_Index    : The minimum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Min_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result, uint32_t* p_Index)
+{
+	#if(_DSP_MIN_USED == 1)
+		arm_min_q15((q15_t*)p_SrcBuff, Buff_Size, (q15_t*)p_Result, p_Index);
+	
+	#else
+		int16_t  temp_min   = p_SrcBuff[0];
+		uint32_t temp_index = 0;
+		
+		for(uint32_t i = 1; i < Buff_Size; i++)
+		{
+			if(p_SrcBuff[i] < temp_min)
+			{
+				temp_min   = p_SrcBuff[i];
+				temp_index = i;
+			}
+		}
+		
+		*p_Result = temp_min;
+		*p_Index  = temp_index;
+	
+	#endif
+}
+
+/** 
+* @description: Computes the minimum value of the data array, Q31. This function returns the minimum value and its position in the array
+* @param  {int32_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int32_t*}  p_Result   : the minimum value of the data array
+* @param  {uint32_t*} p_Index    : The minimum element is indexed in the array
+* @return {void}                         
+* @author: leeqingshui 
+*/
+void Get_DataBuff_Min_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result, uint32_t* p_Index)
+{
+	#if(_DSP_MIN_USED == 1)
+		arm_min_q31((q31_t*)p_SrcBuff, Buff_Size, (q31_t*)p_Result, p_Index);
+	
+	#else
+		int32_t  temp_min   = p_SrcBuff[0];
+		uint32_t temp_index = 0;
+		
+		for(uint32_t i = 1; i < Buff_Size; i++)
+		{
+			if(p_SrcBuff[i] < temp_min)
+			{
+				temp_min   = p_SrcBuff[i];
+				temp_index = i;
+			}
+		}
+		
+		*p_Result = temp_min;
+		*p_Index  = temp_index;
+	
+	#endif
+}
+
+/** 
+* @description: Sum and sum of squares of a Q15 array, two samples per instruction:
+*				__SMLAD(x, 0x00010001) adds both halfwords of x, __SMLALD(x, x) adds both squares into 64 bits
+* @param  {int16_t*}  p_SrcBuff  : A pointer to the array to be processed
+* @param  {uint32_t}  Buff_Size  : Size of Data Buffer
+* @param  {int32_t*}  p_Sum      : Sum of the samples
+* @param  {int64_t*}  p_SumSq    : Sum of squares of the samples (34.30)
+* @return {void}                         
+* @author: leeqingshui 
+*/
+static void DSP_Accumulate_Q15(const int16_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Sum, int64_t* p_SumSq)
+{
+	int32_t  sum      = 0;
+	uint64_t sumSq    = 0;
+	uint32_t Pair_Num = Buff_Size >> 1;
+	uint32_t in       = 0;
+	
+	while(Pair_Num > 0)
+	{
+		/* Two samples in one word load, the array only needs halfword alignment */
+		memcpy(&in, p_SrcBuff, sizeof(in));
+		
+		sum   = (int32_t)__SMLAD(in, 0x00010001U, (uint32_t)sum);
+		sumSq = __SMLALD(in, in, sumSq);
+		
+		p_SrcBuff = p_SrcBuff + 2;
+		Pair_Num--;
+	}
+	
+	if((Buff_Size & 0x1) != 0)
+	{
+		sum   = sum + *p_SrcBuff;
+		sumSq = sumSq + (uint64_t)((int32_t)*p_SrcBuff*(*p_SrcBuff));
+	}
+	
+	*p_Sum   = sum;
+	*p_SumSq = (int64_t)sumSq;
+}
+
+/** 
+* @description: Variance from the sum and the sum of squares of a Q15 array, as arm_var_q15:
+*				Sum(x^2)/(N-1) - Sum(x)^2/(N*(N-1)), in Q30
+* @param  {int32_t}   Sum       : Sum of the samples
+* @param  {int64_t}   SumSq     : Sum of squares of the samples
+* @param  {uint32_t}  Buff_Size : Number of samples, at least 2
+* @return {int64_t}             : Variance, Q30 (may exceed 1.0 for full scale samples)
+* @author: leeqingshui 
+*/
+static int64_t DSP_Var_Q30(int32_t Sum, int64_t SumSq, uint32_t Buff_Size)
+{
+	int64_t meanOfSquares = SumSq / (int64_t)(Buff_Size - 1);
+	int64_t squareOfMean  = (int64_t)Sum*Sum / ((int64_t)Buff_Size*(Buff_Size - 1));
+	
+	return meanOfSquares - squareOfMean;
+}
+
+/** 
+* @description: Square root of a positive integer, rounded down (bit by bit, no division)
+* @param  {uint64_t} In : Input value
+* @return {uint32_t}    : Square root
+* @author: leeqingshui 
+*/
+static uint32_t DSP_Sqrt_U64(uint64_t In)
+{
+	uint64_t Root = 0;
+	uint64_t Bit  = (uint64_t)1 << 62;
+	
+	while(Bit > In)
+	{
+		Bit = Bit >> 2;
+	}
+	
+	while(Bit != 0)
+	{
+		if(In >= Root + Bit)
+		{
+			In   = In - (Root + Bit);
+			Root = (Root >> 1) + Bit;
+		}
+		else
+		{
+			Root = Root >> 1;
+		}
+		Bit = Bit >> 2;
+	}
+	
+	return (uint32_t)Root;
+}
+
+/** 
+* @description: Square root of a Q31 number, 0 for a negative input (same as arm_sqrt_q31)
+* @param  {int32_t} In : Input value, Q31
+* @return {int32_t}    : Square root, Q31
+* @author: leeqingshui 
+*/
+static int32_t DSP_Sqrt_Q31(int32_t In)
+{
+	if(In <= 0)
+	{
+		return 0;
+	}
+	
+	return (int32_t)DSP_Sqrt_U64((uint64_t)In << 31);
+}
+
+/* ====================================Frequency domain functions==================================== */
+
+/** 
+* @description: Prepare the Hann window and the FFT tables of the spectrum analyzer
+* @param  {Spectrum_Analyzer*} p_Spectrum  : Spectrum analyzer
+* @param  {uint16_t}           FFT_Size    : Real FFT length, 256 / 512 / 1024
+* @param  {float32_t}          Sample_Rate : Sampling rate of the input, unit: Hz
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Spectrum_Init(Spectrum_Analyzer* p_Spectrum, uint16_t FFT_Size, float32_t Sample_Rate)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	float32_t Window_Power = 0;
+	
+	if((p_Spectrum == NULL) || !IS_SPECTRUM_FFT_SIZE(FFT_Size) || (Sample_Rate <= 0))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	#if(_DSP_RFFT_USED == 1)
+		if(arm_rfft_fast_init_f32(&p_Spectrum->RFFT_Instance, FFT_Size) != ARM_MATH_SUCCESS)
+		{
+			return ret= (t_FuncRet)Operation_Fail;
+		}
+	
+	#else
+		for(uint16_t k = 0; k < FFT_Size/2; k++)
+		{
+			p_Spectrum->Twiddle[2*k]     =  cosf(2*DSP_PI*k/FFT_Size);
+			p_Spectrum->Twiddle[2*k + 1] = -sinf(2*DSP_PI*k/FFT_Size);
+		}
+	
+	#endif
+	
+	/* Periodic Hann window */
+	for(uint16_t i = 0; i < FFT_Size; i++)
+	{
+		p_Spectrum->Window[i] = 0.5f - 0.5f*cosf(2*DSP_PI*i/FFT_Size);
+		Window_Power = Window_Power + p_Spectrum->Window[i]*p_Spectrum->Window[i];
+	}
+	
+	p_Spectrum->FFT_Size    = FFT_Size;
+	p_Spectrum->Sample_Rate = Sample_Rate;
+	p_Spectrum->Power_Scale = 2.0f/(FFT_Size*Window_Power);
+	
+	return ret;
+}
+
+/** 
+* @description: Window and transform FFT_Size samples, and compute the mean frequency, median frequency and band powers.
+*				The mean of the samples is removed before the window, so the DC bin does not count
+* @param  {Spectrum_Analyzer*} p_Spectrum   : Spectrum analyzer prepared by Spectrum_Init
+* @param  {float32_t*}         p_SrcBuff    : FFT_Size samples, the buffer is not modified
+* @param  {float32_t*}         p_Band_Edges : Band_Num+1 increasing band edges, unit: Hz, NULL if Band_Num is 0
+* @param  {uint8_t}            Band_Num     : Number of bands, 0 ~ SPECTRUM_BAND_MAX
+* @param  {Spectrum_Features*} p_Features   : Spectral features
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Spectrum_Get_Features(Spectrum_Analyzer* p_Spectrum, const float32_t* p_SrcBuff, 
+								const float32_t* p_Band_Edges, uint8_t Band_Num, Spectrum_Features* p_Features)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	uint16_t   FFT_Size = 0;
+	uint16_t   Bin_Num  = 0;
+	float32_t  Bin_Hz   = 0;
+	float32_t  Mean     = 0;
+	float32_t  Total    = 0;
+	float32_t  Moment   = 0;
+	float32_t  Half     = 0;
+	float32_t* p_Power  = NULL;
+	
+	if((p_Spectrum == NULL) || (p_SrcBuff == NULL) || (p_Features == NULL) || 
+	   !IS_SPECTRUM_FFT_SIZE(p_Spectrum->FFT_Size) || (Band_Num > SPECTRUM_BAND_MAX) || 
+	   ((Band_Num != 0) && (p_Band_Edges == NULL)))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	FFT_Size = p_Spectrum->FFT_Size;
+	Bin_Num  = FFT_Size/2;
+	Bin_Hz   = p_Spectrum->Sample_Rate/FFT_Size;
+	
+	for(uint16_t i = 0; i < FFT_Size; i++)
+	{
+		Mean = Mean + p_SrcBuff[i];
+	}
+	Mean = Mean/FFT_Size;
+	
+	for(uint16_t i = 0; i < FFT_Size; i++)
+	{
+		p_Spectrum->Work[i] = (p_SrcBuff[i] - Mean)*p_Spectrum->Window[i];
+	}
+	
+	#if(_DSP_RFFT_USED == 1)
+		arm_rfft_fast_f32(&p_Spectrum->RFFT_Instance, p_Spectrum->Work, p_Spectrum->Spectrum, 0);
+	
+	#else
+		/* N real samples are transformed as N/2 complex samples (even + j*odd), then split */
+		DSP_CFFT_Radix2(p_Spectrum->Work, Bin_Num, p_Spectrum->Twiddle);
+		DSP_RFFT_Split(p_Spectrum->Work, p_Spectrum->Spectrum, FFT_Size, p_Spectrum->Twiddle);
+	
+	#endif
+	
+	/* The work buffer is free after the FFT, it keeps the power of bin 0 ~ N/2 */
+	p_Power    = p_Spectrum->Work;
+	p_Power[0] = 0;
+	for(uint16_t k = 1; k < Bin_Num; k++)
+	{
+		float32_t Re = p_Spectrum->Spectrum[2*k];
+		float32_t Im = p_Spectrum->Spectrum[2*k + 1];
+		
+		p_Power[k] = (Re*Re + Im*Im)*p_Spectrum->Power_Scale;
+		Total      = Total  + p_Power[k];
+		Moment     = Moment + p_Power[k]*k;
+	}
+	/* The Nyquist bin has no mirror image */
+	p_Power[Bin_Num] = p_Spectrum->Spectrum[1]*p_Spectrum->Spectrum[1]*p_Spectrum->Power_Scale*0.5f;
+	Total            = Total  + p_Power[Bin_Num];
+	Moment           = Moment + p_Power[Bin_Num]*Bin_Num;
+	
+	p_Features->Total_Power = Total;
+	p_Features->Mean_Freq   = 0;
+	p_Features->Median_Freq = 0;
+	
+	if(Total > 0)
+	{
+		p_Features->Mean_Freq = Moment/Total*Bin_Hz;
+		
+		/* Bin k covers (k-0.5)*Bin_Hz ~ (k+0.5)*Bin_Hz, the median is interpolated inside the bin */
+		Half = Total*0.5f;
+		for(uint16_t k = 1; k <= Bin_Num; k++)
+		{
+			if((Half <= p_Power[k]) && (p_Power[k] > 0))
+			{
+				p_Features->Median_Freq = (k - 0.5f + Half/p_Power[k])*Bin_Hz;
+				break;
+			}
+			Half = Half - p_Power[k];
+		}
+	}
+	
+	for(uint8_t b = 0; b < Band_Num; b++)
+	{
+		float32_t Band_Power = 0;
+		
+		for(uint16_t k = 1; k <= Bin_Num; k++)
+		{
+			float32_t Freq = k*Bin_Hz;
+			
+			if((Freq >= p_Band_Edges[b]) && (Freq < p_Band_Edges[b + 1]))
+			{
+				Band_Power = Band_Power + p_Power[k];
+			}
+		}
+		
+		p_Features->Band_Power[b] = Band_Power;
+	}
+	p_Features->Band_Num = Band_Num;
+	
+	return ret;
+}
+
+/** 
+* @description: Run the element-wise kernels and their scalar references on a test block (positive, negative and
+*				Q15 full scale samples), compare the outputs and count the cycles (DWT cycle counter, Cycle_Counter_Init)
+* @param  {DataBuff_Benchmark_Result*} p_Result : DSP_BENCHMARK_KERNEL_NUM results
+* @return {t_FuncRet } : Operation_Success if every kernel matches its reference
+* @author: leeqingshui 
+*/
+t_FuncRet DataBuff_Kernel_Benchmark(DataBuff_Benchmark_Result* p_Result)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	static const DSP_Benchmark_Entry Benchmark_Table[DSP_BENCHMARK_KERNEL_NUM] = 
+	{
+		{"Abs_F32",    DSP_Bench_Abs_F,      DSP_Bench_Abs_F_Ref,      (bool)FALSE},
+		{"Offset_F32", DSP_Bench_Offset_F,   DSP_Bench_Offset_F_Ref,   (bool)FALSE},
+		{"Scale_F32",  DSP_Bench_Scale_F,    DSP_Bench_Scale_F_Ref,    (bool)FALSE},
+		{"Abs_Q15",    DSP_Bench_Abs_Q15,    DSP_Bench_Abs_Q15_Ref,    (bool)TRUE},
+		{"Offset_Q15", DSP_Bench_Offset_Q15, DSP_Bench_Offset_Q15_Ref, (bool)TRUE},
+		{"Scale_Q15",  DSP_Bench_Scale_Q15,  DSP_Bench_Scale_Q15_Ref,  (bool)TRUE},
+	};
+	static float32_t In_F[DSP_BENCHMARK_SIZE],   Out_F[DSP_BENCHMARK_SIZE],   Ref_F[DSP_BENCHMARK_SIZE];
+	static int16_t   In_Q15[DSP_BENCHMARK_SIZE], Out_Q15[DSP_BENCHMARK_SIZE], Ref_Q15[DSP_BENCHMARK_SIZE];
+	
+	uint32_t Seed = 12345;
+	
+	if(p_Result == NULL)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	/* Pseudo random samples of both signs, the first ones hit the Q15 saturation */
+	for(uint32_t i = 0; i < DSP_BENCHMARK_SIZE; i++)
+	{
+		Seed      = Seed*1664525U + 1013904223U;
+		In_Q15[i] = (int16_t)(Seed >> 16);
+		In_F[i]   = (float32_t)In_Q15[i]/32768.0f;
+	}
+	In_Q15[0] = INT16_MIN;
+	In_Q15[1] = INT16_MAX;
+	
+	for(uint8_t k = 0; k < DSP_BENCHMARK_KERNEL_NUM; k++)
+	{
+		const DSP_Benchmark_Entry* p_Entry = &Benchmark_Table[k];
+		const void* p_In  = p_Entry->Is_Q15 ? (const void*)In_Q15  : (const void*)In_F;
+		void*       p_Out = p_Entry->Is_Q15 ? (void*)Out_Q15 : (void*)Out_F;
+		void*       p_Ref = p_Entry->Is_Q15 ? (void*)Ref_Q15 : (void*)Ref_F;
+		uint32_t    Cycles;
+		
+		Cycles = GET_CYCLE_COUNT();
+		p_Entry->Kernel(p_In, p_Out, DSP_BENCHMARK_SIZE);
+		p_Result[k].Kernel_Cycles = GET_CYCLE_COUNT() - Cycles;
+		
+		Cycles = GET_CYCLE_COUNT();
+		p_Entry->Reference(p_In, p_Ref, DSP_BENCHMARK_SIZE);
+		p_Result[k].Reference_Cycles = GET_CYCLE_COUNT() - Cycles;
+		
+		p_Result[k].Name = p_Entry->Name;
+		p_Result[k].Pass = (memcmp(p_Out, p_Ref, DSP_BENCHMARK_SIZE*(p_Entry->Is_Q15 ? sizeof(int16_t) : sizeof(float32_t))) == 0) 
+		                   ? (bool)TRUE : (bool)FALSE;
+		
+		if(p_Result[k].Pass == (bool)FALSE)
+		{
+			ret = (t_FuncRet)Operation_Fail;
+		}
+	}
+	
+	return ret;
+}
+
+/* Functions for testing digital signals */
+void DigtalSignal_Process_Test(void)
+{
+	volatile static float32_t Result = 0;
+	volatile static uint32_t  Index  = 0;
+	/* Watch in the debugger: cycles of every element-wise kernel against its reference */
+	static DataBuff_Benchmark_Result Benchmark_Result[DSP_BENCHMARK_KERNEL_NUM];
+	
+	DataBuff_Kernel_Benchmark(Benchmark_Result);
+}
+
+/** 
+* @description: Update every bin of the sliding DFT bank with one sample: the new sample enters,
+*				the sample leaving the window is taken out, and every bin turns by its twiddle
+* @param  {Sliding_DFT_Bank*} p_Bank : Sliding DFT bank
+* @param  {float32_t}         In     : New sample
+* @return {void}                         
+* @author: leeqingshui 
+*/
+static inline void DSP_Sliding_DFT_Update(Sliding_DFT_Bank* p_Bank, float32_t In)
+{
+	float32_t Delta = In - p_Bank->Damping_N*p_Bank->History[p_Bank->Index];
+	
+	p_Bank->History[p_Bank->Index] = In;
+	if(++p_Bank->Index >= p_Bank->Window)
+	{
+		p_Bank->Index = 0;
+	}
+	
+	for(uint8_t b = 0; b < p_Bank->Bin_Num; b++)
+	{
+		float32_t Re = p_Bank->Re[b] + Delta;
+		float32_t Im = p_Bank->Im[b];
+		
+		p_Bank->Re[b] = p_Bank->Cos[b]*Re - p_Bank->Sin[b]*Im;
+		p_Bank->Im[b] = p_Bank->Sin[b]*Re + p_Bank->Cos[b]*Im;
+	}
+}
+
+/** 
+* @description: One tap of the Hamming windowed sinc low pass used by the polyphase resamplers, without normalization
+* @param  {uint32_t}  Tap     : Tap index, 0 - Tap_Num-1
+* @param  {uint32_t}  Tap_Num : Length of the prototype filter
+* @param  {float32_t} Cutoff  : Cutoff, unit: cycles per sample of the up sampled rate
+* @return {float32_t}         : Tap value
+* @author: leeqingshui 
+*/
+static float32_t DSP_Polyphase_Tap(uint32_t Tap, uint32_t Tap_Num, float32_t Cutoff)
+{
+	float32_t t = (float32_t)Tap - 0.5f*(float32_t)(Tap_Num - 1);
+	float32_t Sinc, Window = 1.0f;
+	
+	Sinc = (t == 0) ? 2*Cutoff : sinf(2*DSP_PI*Cutoff*t)/(DSP_PI*t);
+	if(Tap_Num > 1)
+	{
+		Window = 0.54f - 0.46f*cosf(2*DSP_PI*(float32_t)Tap/(float32_t)(Tap_Num - 1));
+	}
+	
+	return Sinc*Window;
+}
+
+/** 
+* @description: Bring an angle into -180 ~ 180 deg, the input is at most one turn outside
+* @param  {float32_t} Angle : Angle, unit: deg
+* @return {float32_t}       : Wrapped angle, unit: deg
+* @author: leeqingshui 
+*/
+static inline float32_t DSP_Wrap_Angle(float32_t Angle)
+{
+	if(Angle >= 180.0f)
+	{
+		Angle = Angle - 360.0f;
+	}
+	else if(Angle < -180.0f)
+	{
+		Angle = Angle + 360.0f;
+	}
+	
+	return Angle;
+}
+
+#if(_DSP_RFFT_USED == 0)
+/** 
+* @description: In place radix-2 complex FFT (decimation in time)
+* @param  {float32_t*} p_Data    : Point_Num complex samples, real and imaginary parts interleaved
+* @param  {uint16_t}   Point_Num : Number of complex samples, a power of 2
+* @param  {float32_t*} p_Twiddle : cos and -sin of 2*pi*k/(2*Point_Num), k = 0 ~ Point_Num-1, interleaved
+* @return {void}                         
+* @author: leeqingshui 
+*/
+static void DSP_CFFT_Radix2(float32_t* p_Data, uint16_t Point_Num, const float32_t* p_Twiddle)
+{
+	float32_t tempr;
+	uint16_t  j = 0;
+	
+	/* Bit reversed order */
+	for(uint16_t i = 0; i < Point_Num; i++)
+	{
+		uint16_t m = Point_Num >> 1;
+		
+		if(i < j)
+		{
+			SWAP(p_Data[2*i],     p_Data[2*j]);
+			SWAP(p_Data[2*i + 1], p_Data[2*j + 1]);
+		}
+		
+		while((m >= 1) && (j >= m))
+		{
+			j = j - m;
+			m = m >> 1;
+		}
+		j = j + m;
+	}
+	
+	/* Butterflies, the twiddle table is made for twice the length so it is read with a stride */
+	for(uint16_t Length = 2; Length <= Point_Num; Length = Length << 1)
+	{
+		uint16_t Half   = Length >> 1;
+		uint16_t Stride = (2*Point_Num)/Length;
+		
+		for(uint16_t k = 0; k < Half; k++)
+		{
+			float32_t wr = p_Twiddle[2*k*Stride];
+			float32_t wi = p_Twiddle[2*k*Stride + 1];
+			
+			for(uint16_t i = k; i < Point_Num; i = i + Length)
+			{
+				uint16_t  m  = i + Half;
+				float32_t tr = wr*p_Data[2*m]     - wi*p_Data[2*m + 1];
+				float32_t ti = wr*p_Data[2*m + 1] + wi*p_Data[2*m];
+				
+				p_Data[2*m]     = p_Data[2*i]     - tr;
+				p_Data[2*m + 1] = p_Data[2*i + 1] - ti;
+				p_Data[2*i]     = p_Data[2*i]     + tr;
+				p_Data[2*i + 1] = p_Data[2*i + 1] + ti;
+			}
+		}
+	}
+}
+
+/** 
+* @description: Split the complex FFT Z of z[n] = x[2n] + j*x[2n+1] into the real FFT X of x:
+*				X[k] = (Z[k] + Z*[N/2-k])/2 - j*W^k*(Z[k] - Z*[N/2-k])/2, W = exp(-j*2*pi/N).
+*				The output is packed as the CMSIS real FFT: X[0], X[N/2], Re X[1], Im X[1], ...
+* @param  {float32_t*} p_SrcBuff : N/2 complex samples of Z
+* @param  {float32_t*} p_DstBuff : N packed real FFT values
+* @param  {uint16_t}   FFT_Size  : N
+* @param  {float32_t*} p_Twiddle : cos and -sin of 2*pi*k/N, k = 0 ~ N/2-1, interleaved
+* @return {void}                         
+* @author: leeqingshui 
+*/
+static void DSP_RFFT_Split(const float32_t* p_SrcBuff, float32_t* p_DstBuff, uint16_t FFT_Size, const float32_t* p_Twiddle)
+{
+	uint16_t Point_Num = FFT_Size/2;
+	
+	p_DstBuff[0] = p_SrcBuff[0] + p_SrcBuff[1];
+	p_DstBuff[1] = p_SrcBuff[0] - p_SrcBuff[1];
+	
+	for(uint16_t k = 1; k < Point_Num; k++)
+	{
+		float32_t Ar = p_SrcBuff[2*k];
+		float32_t Ai = p_SrcBuff[2*k + 1];
+		float32_t Br =  p_SrcBuff[2*(Point_Num - k)];
+		float32_t Bi = -p_SrcBuff[2*(Point_Num - k) + 1];
+		float32_t Dr = Ar - Br;
+		float32_t Di = Ai - Bi;
+		float32_t wr = p_Twiddle[2*k];
+		float32_t wi = p_Twiddle[2*k + 1];
+		
+		p_DstBuff[2*k]     = 0.5f*((Ar + Br) + (wr*Di + wi*Dr));
+		p_DstBuff[2*k + 1] = 0.5f*((Ai + Bi) - (wr*Dr - wi*Di));
+	}
+}
+#endif
+
+/* Kernels of the benchmark table with the parameters fixed: offset 0.25 (0x2000 in Q15), scale 0.75 (0x6000 in Q15) */
+static void DSP_Bench_Abs_F(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	Get_DataBuff_Abs((float32_t*)p_SrcBuff, (float32_t*)p_DstBuff, Buff_Size);
+}
+
+static void DSP_Bench_Abs_F_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		((float32_t*)p_DstBuff)[i] = fabsf(((const float32_t*)p_SrcBuff)[i]);
+	}
+}
+
+static void DSP_Bench_Offset_F(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	Get_DataBuff_Offeset((float32_t*)p_SrcBuff, 0.25f, (float32_t*)p_DstBuff, Buff_Size);
+}
+
+static void DSP_Bench_Offset_F_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		((float32_t*)p_DstBuff)[i] = ((const float32_t*)p_SrcBuff)[i] + 0.25f;
+	}
+}
+
+static void DSP_Bench_Scale_F(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	Get_DataBuff_Scale((float32_t*)p_SrcBuff, 0.75f, (float32_t*)p_DstBuff, Buff_Size);
+}
+
+static void DSP_Bench_Scale_F_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		((float32_t*)p_DstBuff)[i] = ((const float32_t*)p_SrcBuff)[i]*0.75f;
+	}
+}
+
+static void DSP_Bench_Abs_Q15(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	Get_DataBuff_Abs_Q15((int16_t*)p_SrcBuff, (int16_t*)p_DstBuff, Buff_Size);
+}
+
+static void DSP_Bench_Abs_Q15_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		int32_t temp = ((const int16_t*)p_SrcBuff)[i];
+		
+		((int16_t*)p_DstBuff)[i] = (int16_t)((temp < 0) ? ((-temp > INT16_MAX) ? INT16_MAX : -temp) : temp);
+	}
+}
+
+static void DSP_Bench_Offset_Q15(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	Get_DataBuff_Offeset_Q15((int16_t*)p_SrcBuff, 0x2000, (int16_t*)p_DstBuff, Buff_Size);
+}
+
+static void DSP_Bench_Offset_Q15_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		int32_t temp = ((const int16_t*)p_SrcBuff)[i] + 0x2000;
+		
+		((int16_t*)p_DstBuff)[i] = (int16_t)((temp > INT16_MAX) ? INT16_MAX : temp);
+	}
+}
+
+static void DSP_Bench_Scale_Q15(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	Get_DataBuff_Scale_Q15((int16_t*)p_SrcBuff, 0x6000, 0, (int16_t*)p_DstBuff, Buff_Size);
+}
+
+static void DSP_Bench_Scale_Q15_Ref(const void* p_SrcBuff, void* p_DstBuff, uint32_t Buff_Size)
+{
+	for(uint32_t i = 0; i < Buff_Size; i++)
+	{
+		((int16_t*)p_DstBuff)[i] = (int16_t)(((int32_t)((const int16_t*)p_SrcBuff)[i]*0x6000) >> 15);
+	}
+}
@@ -19,6 +19,48 @@
 
 /* Mean filter times, the more times, the slower the sensor data transformation */
 #define MEAN_FILTER_NUM	3
+/* Maximum window length of the moving average filter */
+#define MOVING_AVERAGE_WINDOW_MAX		256U
+/* Macro function to determine whether the moving average window length is correct */
+#define IS_MOVING_AVERAGE_WINDOW(W)		(((W) >= 1) && ((W) <= MOVING_AVERAGE_WINDOW_MAX))
+/* Maximum number of channels in one filter bank */
+#define FILTER_BANK_CHANNEL_MAX			8U
+/* Maximum window length of the moving average filter bank */
+#define MOVING_AVERAGE_BANK_WINDOW_MAX	64U
+/* Macro function to determine whether the number of channels of a filter bank is correct */
+#define IS_FILTER_BANK_CHANNEL_NUM(N)	(((N) >= 1) && ((N) <= FILTER_BANK_CHANNEL_MAX))
+/* The Kalman gain is taken as steady when one step changes it by less than this fraction */
+#define KALMAN_STEADY_TOLERANCE			1.0e-6f
+/* Maximum number of second order stages in one biquad cascade */
+#define BIQUAD_STAGE_MAX				6U
+/* Number of coefficients of one biquad stage: b0, b1, b2, a1, a2 */
+#define BIQUAD_COEFF_NUM				5U
+/* 
+	The Q31 coefficients are scaled by 2^-BIQUAD_Q31_POST_SHIFT so that |a1| < 2 fits, 
+	the output is shifted back by the same amount
+*/
+#define BIQUAD_Q31_POST_SHIFT			1
+/* Largest window of the sliding DFT bank, 400 samples give 5Hz bins at 2000Hz */
+#define SLIDING_DFT_WINDOW_MAX			400U
+/* Maximum number of bins tracked by one sliding DFT bank */
+#define SLIDING_DFT_BIN_MAX				8U
+/* Pole radius of the sliding DFT resonators, slightly below 1 so that the rounding errors die out */
+#define SLIDING_DFT_DAMPING				0.99999f
+/* Largest real FFT length of the spectrum analyzer */
+#define SPECTRUM_FFT_SIZE_MAX			1024U
+/* Macro function to determine whether the real FFT length is supported */
+#define IS_SPECTRUM_FFT_SIZE(N)			(((N) == 256) || ((N) == 512) || ((N) == 1024))
+/* Maximum number of bands whose power is reported by the spectrum analyzer */
+#define SPECTRUM_BAND_MAX				4U
+/* Largest up / down sampling factor of a polyphase resampler */
+#define POLYPHASE_FACTOR_MAX			64U
+/* Macro function to determine whether an up / down sampling factor is correct */
+#define IS_POLYPHASE_FACTOR(F)			(((F) >= 1) && ((F) <= POLYPHASE_FACTOR_MAX))
+/* Number of element-wise kernels measured by DataBuff_Kernel_Benchmark */
+#define DSP_BENCHMARK_KERNEL_NUM		6U
+/* Initial covariance of the angle Kalman filter: the angle is unknown, the gyro bias is within a few deg/s */
+#define KALMAN_ANGLE_P0_ANGLE			1000.0f
+#define KALMAN_ANGLE_P0_BIAS			1.0f
 
 /* Whether to use functions from the ARM-DSP library or use inefficient digital processing libraries */
 #define _ARM_DSP_USED			0U
@@ -26,8 +68,16 @@
 #if(_ARM_DSP_USED == 1)
 	/* Basic DSP functions macro definitions */
 	#define _DSP_ABS_USED 			1U
-	#define _DSP_OFFSET_USED 		0U
-	#define _DSP_SCALE_USED 		0U
+	#define _DSP_OFFSET_USED 		1U
+	#define _DSP_SCALE_USED 		1U
+	/* Filter bank functions macro definitions */
+	#define _DSP_FILTER_BANK_USED 	1U
+	/* Filtering functions macro definitions */
+	#define _DSP_BIQUAD_USED 		1U
+	/* Frequency domain functions macro definitions */
+	#define _DSP_RFFT_USED 			1U
+	/* Matrix functions macro definitions */
+	#define _DSP_MATRIX_USED 		1U
 	/* Statistics DSP functions macro definitions */
 	#define _DSP_MAX_USED 			1U
 	#define _DSP_MEAN_USED 			1U
@@ -41,6 +91,10 @@
 	#define _DSP_OFFSET_USED 		0U
 	#define _DSP_MAX_USED 			0U
 	#define _DSP_SCALE_USED 		0U
+	#define _DSP_FILTER_BANK_USED 	0U
+	#define _DSP_BIQUAD_USED 		0U
+	#define _DSP_RFFT_USED 			0U
+	#define _DSP_MATRIX_USED 		0U
 	#define _DSP_MEAN_USED 			0U
 	#define _DSP_MIN_USED 			0U
 	#define _DSP_POWER_USED 		0U
@@ -49,6 +103,11 @@
 	#define _DSP_VAR_USED 			0U
 #endif
 
+#if((_DSP_RFFT_USED == 1) || (_DSP_MATRIX_USED == 1))
+	/* The CMSIS real FFT and matrix instances are members of Spectrum_Analyzer and Kalman_Angle_Filter */
+	#include "arm_math.h"
+#endif
+
 /* Round the floating point number x to uint16_t */
 #define ROUND_TO_UINT16(x)   ((uint16_t)(x)+0.5)>(x)? ((uint16_t)(x)):((uint16_t)(x)+1)
 /* Two numbers exchange macro function */
@@ -84,6 +143,41 @@ typedef struct
 	
 }Mean_Filter_U16;
 
+/* 
+	Moving average filter structure, it keeps its history between calls:
+	the running sum is updated with the incoming and the outgoing sample, so one update costs O(1)
+*/
+typedef struct 
+{
+	/* Circular history of the last Window samples */
+	uint16_t History[MOVING_AVERAGE_WINDOW_MAX];
+	/* The sum of the samples in the history */
+	uint32_t Sum;
+	/* Window length, 1 - MOVING_AVERAGE_WINDOW_MAX */
+	uint16_t Window;
+	/* Position of the oldest sample in the history */
+	uint16_t Index;
+	/* Number of samples in the history, it is smaller than Window until the history is filled */
+	uint16_t Count;
+	
+}Moving_Average_U16;
+
+/* Moving average filter structure, floating point version */
+typedef struct 
+{
+	/* Circular history of the last Window samples */
+	float History[MOVING_AVERAGE_WINDOW_MAX];
+	/* The sum of the samples in the history, summed again every Window samples to stop rounding drift */
+	float Sum;
+	/* Window length, 1 - MOVING_AVERAGE_WINDOW_MAX */
+	uint16_t Window;
+	/* Position of the oldest sample in the history */
+	uint16_t Index;
+	/* Number of samples in the history, it is smaller than Window until the history is filled */
+	uint16_t Count;
+	
+}Moving_Average_F;
+
 /* Kalman Filter Structure */
 typedef struct 
 {
@@ -113,6 +207,279 @@ typedef struct
 	float kGain;
 }Kalman_Filter;
 
+/* 
+	Kalman filter bank: the state of Channel_Num channels stored as structure of arrays,
+	one call filters one frame (one sample of every channel) with the same loop over all channels
+*/
+typedef struct 
+{
+	/* Last time Kalman filter predicted of every channel */
+	float last_data[FILTER_BANK_CHANNEL_MAX];
+	/* Estimate deviation of every channel */
+	float error[FILTER_BANK_CHANNEL_MAX];
+	/* Process noise of every channel */
+	float q[FILTER_BANK_CHANNEL_MAX];
+	/* Measurement noise of every channel */
+	float r[FILTER_BANK_CHANNEL_MAX];
+	/* Kalman filter gain of every channel */
+	float kGain[FILTER_BANK_CHANNEL_MAX];
+	/* Whether the gain of every channel has reached its steady state, it is then fixed and no division is done */
+	bool  Steady[FILTER_BANK_CHANNEL_MAX];
+	/* Number of channels in use, 1 - FILTER_BANK_CHANNEL_MAX */
+	uint32_t Channel_Num;
+}Kalman_Filter_Bank;
+
+/* 
+	Angle Kalman filter of one axis, state x = [angle; gyro bias]:
+	x[k] = F*x[k-1] + B*rate, F = [1 -Dt; 0 1], B = [Dt; 0], the angle is measured: H = [1 0].
+	All matrices are 2x2 row major and preallocated in the structure
+*/
+typedef struct 
+{
+	/* Estimated angle (deg) and gyro bias (deg/s) */
+	float32_t State[2];
+	/* Error covariance */
+	float32_t P[4];
+	/* State transition and its transpose */
+	float32_t F[4];
+	float32_t F_T[4];
+	/* Process noise covariance */
+	float32_t Q[4];
+	/* Intermediate product F*P */
+	float32_t Temp[4];
+	/* Measurement noise of the angle, unit: deg^2 */
+	float32_t R;
+	/* Update period, unit: s */
+	float32_t Dt;
+#if(_DSP_MATRIX_USED == 1)
+	/* CMSIS matrix instances over the arrays above */
+	arm_matrix_instance_f32 Mat_P;
+	arm_matrix_instance_f32 Mat_F;
+	arm_matrix_instance_f32 Mat_F_T;
+	arm_matrix_instance_f32 Mat_Q;
+	arm_matrix_instance_f32 Mat_Temp;
+#endif
+}Kalman_Angle_Filter;
+
+/* 
+	Moving average filter bank: one row of the history is one frame,
+	so the running sums of all channels are updated with two vector operations per frame
+*/
+typedef struct 
+{
+	/* Circular history of the last Window frames */
+	float History[MOVING_AVERAGE_BANK_WINDOW_MAX][FILTER_BANK_CHANNEL_MAX];
+	/* The sum of the history of every channel */
+	float Sum[FILTER_BANK_CHANNEL_MAX];
+	/* Number of channels in use, 1 - FILTER_BANK_CHANNEL_MAX */
+	uint32_t Channel_Num;
+	/* Window length, 1 - MOVING_AVERAGE_BANK_WINDOW_MAX */
+	uint16_t Window;
+	/* Position of the oldest frame in the history */
+	uint16_t Index;
+	/* Number of frames in the history, it is smaller than Window until the history is filled */
+	uint16_t Count;
+}Moving_Average_Bank_F;
+
+/* Type of a second order stage designed by Biquad_Design */
+typedef enum
+{
+	BIQUAD_LOWPASS  = 0,
+	BIQUAD_HIGHPASS = 1,
+	BIQUAD_NOTCH    = 2
+}Biquad_Type;
+
+/* 
+	Biquad cascade, floating point, Direct Form II transposed.
+	Every stage computes y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] + a1*y[n-1] + a2*y[n-2]
+	(the CMSIS convention: a1 and a2 have the opposite sign of the usual transfer function)
+*/
+typedef struct 
+{
+	/* Coefficients of every stage: b0, b1, b2, a1, a2 */
+	float32_t Coeffs[BIQUAD_COEFF_NUM*BIQUAD_STAGE_MAX];
+	/* Two state variables of every stage */
+	float32_t State[2*BIQUAD_STAGE_MAX];
+	/* Number of stages in use */
+	uint8_t   Stage_Num;
+}Biquad_Cascade_F;
+
+/* 
+	Biquad cascade, Q31, Direct Form I with a 64 bits accumulator
+*/
+typedef struct 
+{
+	/* Coefficients of every stage: b0, b1, b2, a1, a2, scaled by 2^-BIQUAD_Q31_POST_SHIFT */
+	int32_t Coeffs[BIQUAD_COEFF_NUM*BIQUAD_STAGE_MAX];
+	/* Four state variables of every stage: x[n-1], x[n-2], y[n-1], y[n-2] */
+	int32_t State[4*BIQUAD_STAGE_MAX];
+	/* Number of stages in use */
+	uint8_t Stage_Num;
+}Biquad_Cascade_Q31;
+
+/* 
+	Sliding DFT bank: Bin_Num bins of a Window samples long DFT, updated every sample in O(Bin_Num)
+	S[n] = r*exp(j*2*pi*k/N)*(S[n-1] + x[n] - r^N*x[n-N])
+*/
+typedef struct 
+{
+	/* Last Window samples, needed to take the oldest sample out of every bin */
+	float32_t History[SLIDING_DFT_WINDOW_MAX];
+	/* Real and imaginary part of every bin */
+	float32_t Re[SLIDING_DFT_BIN_MAX];
+	float32_t Im[SLIDING_DFT_BIN_MAX];
+	/* r*cos(2*pi*k/N) and r*sin(2*pi*k/N) of every bin */
+	float32_t Cos[SLIDING_DFT_BIN_MAX];
+	float32_t Sin[SLIDING_DFT_BIN_MAX];
+	/* DFT index k of every bin */
+	uint16_t  Bin_Index[SLIDING_DFT_BIN_MAX];
+	/* r^N, the weight of the sample leaving the window */
+	float32_t Damping_N;
+	/* Window length N, 2 - SLIDING_DFT_WINDOW_MAX */
+	uint16_t  Window;
+	/* Position of the oldest sample in the history */
+	uint16_t  Index;
+	/* Number of bins in use, 1 - SLIDING_DFT_BIN_MAX */
+	uint8_t   Bin_Num;
+}Sliding_DFT_Bank;
+
+/* 
+	EMG linear envelope filter: baseline removal, full wave rectification, 2nd order low pass and decimation 
+	in one pass over the input
+*/
+typedef struct 
+{
+	/* Low pass coefficients: b0, b1, b2, a1, a2 (Biquad_Design convention) */
+	float32_t Coeffs[BIQUAD_COEFF_NUM];
+	/* Low pass state, Direct Form II transposed */
+	float32_t State[2];
+	/* Tracked DC offset of the input and the weight of one sample */
+	float32_t Baseline;
+	float32_t Baseline_Alpha;
+	/* Whether the baseline has been started from the first sample */
+	bool      Baseline_Valid;
+	/* One output every Decimation input samples */
+	uint16_t  Decimation;
+	/* Number of input samples since the last output */
+	uint16_t  Phase;
+}Envelope_Filter;
+
+/* 
+	Polyphase FIR resampler, floating point: up sampling by Interpolation, low pass, down sampling by Decimation,
+	only the phase that lands on an output sample is computed. Interpolation 1 is a decimator, Decimation 1 an interpolator
+*/
+typedef struct 
+{
+	/* Interpolation*Phase_Taps coefficients from Polyphase_FIR_Design, can be shared by several resamplers */
+	const float32_t* p_Coeffs;
+	/* Delay line of 2*Phase_Taps samples, every input is written twice */
+	float32_t*       p_State;
+	/* Taps of every phase */
+	uint16_t         Phase_Taps;
+	/* Position of the next input in the delay line */
+	uint16_t         Index;
+	/* Up / down sampling factors */
+	uint8_t          Interpolation;
+	uint8_t          Decimation;
+	/* Phase of the next output relative to the latest input, unit: up sampled samples */
+	uint16_t         Phase;
+}Polyphase_FIR_F;
+
+/* 
+	Polyphase FIR resampler, Q15 coefficients and samples, 64 bits accumulator
+*/
+typedef struct 
+{
+	/* Interpolation*Phase_Taps coefficients from Polyphase_FIR_Design_Q15, can be shared by several resamplers */
+	const int16_t* p_Coeffs;
+	/* Delay line of 2*Phase_Taps samples, every input is written twice */
+	int16_t*       p_State;
+	/* Taps of every phase */
+	uint16_t       Phase_Taps;
+	/* Position of the next input in the delay line */
+	uint16_t       Index;
+	/* Up / down sampling factors */
+	uint8_t        Interpolation;
+	uint8_t        Decimation;
+	/* Phase of the next output relative to the latest input, unit: up sampled samples */
+	uint16_t       Phase;
+}Polyphase_FIR_Q15;
+
+/* Time domain statistics of a buffer, all filled by Get_DataBuff_Statistics in a single pass */
+typedef struct 
+{
+	/* Average of the buffer */
+	float32_t Mean;
+	/* Sample variance (divided by Buff_Size - 1, as Get_DataBuff_Var) */
+	float32_t Var;
+	/* Standard deviation */
+	float32_t Std;
+	/* Root Mean Sqaure */
+	float32_t Rms;
+	/* Sum of squares */
+	float32_t Power;
+	/* Maximum value and its position in the buffer */
+	float32_t Max;
+	uint32_t  Max_Index;
+	/* Minimum value and its position in the buffer */
+	float32_t Min;
+	uint32_t  Min_Index;
+}DataBuff_Statistics;
+
+/* 
+	Spectrum analyzer: Hann window and real FFT of FFT_Size samples, the window and
+	the FFT tables are shared by every channel analyzed with the same length and sampling rate
+*/
+typedef struct 
+{
+#if(_DSP_RFFT_USED == 1)
+	/* CMSIS real FFT instance */
+	arm_rfft_fast_instance_f32 RFFT_Instance;
+#else
+	/* cos and -sin of 2*pi*k/FFT_Size, k = 0 ~ FFT_Size/2-1, interleaved */
+	float32_t Twiddle[SPECTRUM_FFT_SIZE_MAX];
+#endif
+	/* Hann window */
+	float32_t Window[SPECTRUM_FFT_SIZE_MAX];
+	/* Windowed input, it is destroyed by the FFT */
+	float32_t Work[SPECTRUM_FFT_SIZE_MAX];
+	/* FFT output packed as the CMSIS real FFT: Re[0], Re[N/2], Re[1], Im[1], ... */
+	float32_t Spectrum[SPECTRUM_FFT_SIZE_MAX];
+	/* Real FFT length, 256 / 512 / 1024 */
+	uint16_t  FFT_Size;
+	/* Sampling rate, unit: Hz */
+	float32_t Sample_Rate;
+	/* 2/(FFT_Size*Sum(w^2)): scales |X[k]|^2 so that the sum over all bins is the mean square of the input */
+	float32_t Power_Scale;
+}Spectrum_Analyzer;
+
+/* Result of one kernel of DataBuff_Kernel_Benchmark */
+typedef struct 
+{
+	/* Kernel name */
+	const char* Name;
+	/* Cycles spent on one test block by the kernel and by the plain scalar reference */
+	uint32_t    Kernel_Cycles;
+	uint32_t    Reference_Cycles;
+	/* Whether the kernel output equals the reference output */
+	bool        Pass;
+}DataBuff_Benchmark_Result;
+
+/* Spectral features of one window */
+typedef struct 
+{
+	/* Mean frequency (power weighted), unit: Hz */
+	float32_t Mean_Freq;
+	/* Median frequency, it splits the power into two equal halves, unit: Hz */
+	float32_t Median_Freq;
+	/* Power of the whole spectrum except DC, unit: square of the input unit */
+	float32_t Total_Power;
+	/* Power of every band, Band_Power[i] covers p_Band_Edges[i] ~ p_Band_Edges[i+1] */
+	float32_t Band_Power[SPECTRUM_BAND_MAX];
+	/* Number of bands in use */
+	uint8_t   Band_Num;
+}Spectrum_Features;
+
 /* Function declaration-------------------------------------------------------*/
 
 /* =====================================Time domain filtering algorithm================================= */
@@ -127,34 +494,99 @@ uint16_t Data_Mean_Filter_U16(Mean_Filter_U16* p_MeanFilterStruct,uint16_t Temp_
 /* Mean filtering Reset function */
 void Mean_Filter_Rest_U16(Mean_Filter_U16* p_MeanFilterStruct);
 
+/* Initialize the moving average filter */
+t_FuncRet Moving_Average_Init_U16(Moving_Average_U16* p_Filter, uint16_t Window);
+/* Filter one sample by the moving average filter */
+uint16_t Moving_Average_Update_U16(Moving_Average_U16* p_Filter, uint16_t InData);
+/* Filter a block of samples (with a stride, e.g. one channel of a DMA block) by the moving average filter */
+void Moving_Average_Block_U16(Moving_Average_U16* p_Filter, const uint16_t* p_SrcBuff, uint32_t Stride, uint16_t* p_DstBuff, uint32_t Buff_Size);
+
+/* Initialize the moving average filter */
+t_FuncRet Moving_Average_Init_F(Moving_Average_F* p_Filter, uint16_t Window);
+/* Filter one sample by the moving average filter */
+float Moving_Average_Update_F(Moving_Average_F* p_Filter, float InData);
+/* Filter a block of samples (with a stride) by the moving average filter */
+void Moving_Average_Block_F(Moving_Average_F* p_Filter, const float* p_SrcBuff, uint32_t Stride, float* p_DstBuff, uint32_t Buff_Size);
+
 /* Initialize the Kalman filter */
 void KalmanFilter_Init(Kalman_Filter* p_Kalman_Filter);
 /* Data were filtered by Kalman filter */
 float KalmanFilter_Calculate(Kalman_Filter* p_Kalman_Filter , float InData);
 
+/* Initialize the Kalman filter bank */
+t_FuncRet KalmanFilter_Bank_Init(Kalman_Filter_Bank* p_Bank, uint32_t Channel_Num);
+/* One frame (one sample of every channel) is filtered by the Kalman filter bank */
+void KalmanFilter_Bank_Calculate(Kalman_Filter_Bank* p_Bank, const float* p_InData, float* p_OutData);
+/* Give every channel of the Kalman filter bank its steady state gain */
+void KalmanFilter_Bank_Set_Steady(Kalman_Filter_Bank* p_Bank);
+/* Filter a block of samples of one channel by the Kalman filter bank */
+void KalmanFilter_Bank_Process_U16(Kalman_Filter_Bank* p_Bank, uint32_t Channel, const uint16_t* p_SrcBuff, uint32_t Stride, float* p_DstBuff, uint32_t Block_Size);
+
+/* Initialize the angle Kalman filter of one axis */
+t_FuncRet Kalman_Angle_Init(Kalman_Angle_Filter* p_Filter, float32_t Dt, float32_t Q_Angle, float32_t Q_Bias, float32_t R_Angle);
+/* Fuse one measured angle and angular rate by the angle Kalman filter */
+float32_t Kalman_Angle_Update(Kalman_Angle_Filter* p_Filter, float32_t Angle, float32_t Rate);
+
+/* Initialize the moving average filter bank */
+t_FuncRet Moving_Average_Bank_Init_F(Moving_Average_Bank_F* p_Bank, uint32_t Channel_Num, uint16_t Window);
+/* One frame (one sample of every channel) is filtered by the moving average filter bank */
+void Moving_Average_Bank_Update_F(Moving_Average_Bank_F* p_Bank, const float* p_InData, float* p_OutData);
+
+/* Design the coefficients of one second order stage (RBJ audio EQ cookbook) */
+t_FuncRet Biquad_Design(Biquad_Type Type, float32_t Sample_Rate, float32_t F0, float32_t Q, float32_t* p_Coeffs);
+/* Load a coefficient set into the floating point biquad cascade and clear its state */
+t_FuncRet Biquad_Cascade_Init_F(Biquad_Cascade_F* p_Cascade, const float32_t* p_Coeffs, uint8_t Stage_Num);
+/* Filter a block of samples by the floating point biquad cascade */
+void Biquad_Cascade_Process_F(Biquad_Cascade_F* p_Cascade, const float32_t* p_SrcBuff, float32_t* p_DstBuff, uint32_t Block_Size);
+/* Load a coefficient set (floating point) into the Q31 biquad cascade and clear its state */
+t_FuncRet Biquad_Cascade_Init_Q31(Biquad_Cascade_Q31* p_Cascade, const float32_t* p_Coeffs, uint8_t Stage_Num);
+/* Filter a block of samples by the Q31 biquad cascade */
+void Biquad_Cascade_Process_Q31(Biquad_Cascade_Q31* p_Cascade, const int32_t* p_SrcBuff, int32_t* p_DstBuff, uint32_t Block_Size);
+
+/* Choose the bins of the sliding DFT bank and clear its history */
+t_FuncRet Sliding_DFT_Bank_Init(Sliding_DFT_Bank* p_Bank, uint16_t Window, float32_t Sample_Rate, const float32_t* p_Freq, uint8_t Bin_Num);
+/* Update every bin of the sliding DFT bank with a block of samples */
+void Sliding_DFT_Bank_Process(Sliding_DFT_Bank* p_Bank, const float32_t* p_SrcBuff, uint32_t Block_Size);
+void Sliding_DFT_Bank_Process_U16(Sliding_DFT_Bank* p_Bank, const uint16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size);
+/* Get the amplitude of the sinusoid in every bin of the sliding DFT bank */
+void Sliding_DFT_Bank_Get_Magnitude(const Sliding_DFT_Bank* p_Bank, float32_t* p_Magnitude);
+
+/* Prepare the EMG linear envelope filter and clear its state */
+t_FuncRet Envelope_Filter_Init(Envelope_Filter* p_Filter, float32_t Sample_Rate, float32_t Cutoff_Hz, float32_t Baseline_Hz, uint16_t Decimation);
+/* Filter a block of uint16_t samples into the decimated envelope */
+uint32_t Envelope_Filter_Process_U16(Envelope_Filter* p_Filter, const uint16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, float32_t* p_DstBuff);
+
+/* Design the low pass of a polyphase resampler, floating point and Q15 */
+t_FuncRet Polyphase_FIR_Design(uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, float32_t* p_Coeffs);
+t_FuncRet Polyphase_FIR_Design_Q15(uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, int16_t* p_Coeffs);
+/* Prepare a polyphase resampler and clear its delay line, floating point and Q15 */
+t_FuncRet Polyphase_FIR_Init_F(Polyphase_FIR_F* p_Resampler, uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, 
+							   const float32_t* p_Coeffs, float32_t* p_State);
+t_FuncRet Polyphase_FIR_Init_Q15(Polyphase_FIR_Q15* p_Resampler, uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, 
+								 const int16_t* p_Coeffs, int16_t* p_State);
+/* Resample a block of samples, floating point and Q15 */
+uint32_t Polyphase_FIR_Process_F(Polyphase_FIR_F* p_Resampler, const float32_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, float32_t* p_DstBuff);
+uint32_t Polyphase_FIR_Process_Q15(Polyphase_FIR_Q15* p_Resampler, const int16_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, int16_t* p_DstBuff);
+
 /* ==========================================Basic DSP functions======================================== */
 
+/* 
+	Buff_Size is the number of elements: pass sizeof(array)/sizeof(array[0]), not sizeof(array),
+	a size in bytes runs past the end of the array and ends in a Hardfault
+*/
 /* Get the absolute value of an array */
 void Get_DataBuff_Abs(float32_t* p_SrcBuff,float32_t* p_DstpBuff,uint32_t Buff_Size);
-/* !! 
-	This function causes Hardfault for an unknown reason and does not perform properly !!
-	Notice here that if you use sizeof on an array to find its length, it will cause Hardfault
-*/
+void Get_DataBuff_Abs_Q15(int16_t* p_SrcBuff, int16_t* p_DstpBuff, uint32_t Buff_Size);
 /* Get the offset additioned value of an array */
 void Get_DataBuff_Offeset(float32_t* p_SrcBuff, float32_t offset,float32_t* p_DstpBuff,uint32_t Buff_Size);
-/* !! 
-	This function causes Hardfault for an unknown reason and does not perform properly !!
-	Notice here that if you use sizeof on an array to find its length, it will cause Hardfault
-*/
+void Get_DataBuff_Offeset_Q15(int16_t* p_SrcBuff, int16_t offset, int16_t* p_DstpBuff, uint32_t Buff_Size);
 /* The target array is multiplied by the proportionality constant */
 void Get_DataBuff_Scale(float32_t* p_SrcBuff, float32_t ratio,float32_t* p_DstpBuff,uint32_t Buff_Size);
+/* The Q15 array is multiplied by a Q15 proportionality constant and shifted left */
+void Get_DataBuff_Scale_Q15(int16_t* p_SrcBuff, int16_t Scale_Fract, int8_t Shift, int16_t* p_DstpBuff, uint32_t Buff_Size);
 
 /* =======================================Statistics DSP functions===================================== */
 
-/* !! 
-	This function causes Hardfault for an unknown reason and does not perform properly !!
-	Notice here that if you use sizeof on an array to find its length, it will cause Hardfault
-*/
 /* Computes the maximum value of the data array. This function returns the maximum value and its position in the array. */
 void Get_DataBuff_Max(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result, uint32_t* p_Index);
 void Get_DataBuff_Max_U16(uint16_t* p_SrcBuff, uint32_t Buff_Size, uint16_t* p_Result, uint32_t* p_Index);
@@ -172,7 +604,48 @@ void Get_DataBuff_Rms(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Res
 void Get_DataBuff_Std(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result);
 /* Get the array variance */
 void Get_DataBuff_Var(float32_t* p_SrcBuff, uint32_t Buff_Size, float32_t* p_Result);
+/* Computes mean, variance, standard deviation, rms, power, maximum and minimum of the array in one pass */
+t_FuncRet Get_DataBuff_Statistics(float32_t* p_SrcBuff, uint32_t Buff_Size, DataBuff_Statistics* p_Result);
+
+/* ================================Fixed point (Q15 / Q31) statistics=============================== */
+
+/*
+	Raw 12-bit ADC codes (and the oversampled data of Get_ADC_Oversampled_Data) fit in Q15 without
+	conversion, so these can run directly on an ADC block. Without CMSIS-DSP the Q15 kernels use
+	the dual 16-bit MAC instructions. Results follow the CMSIS output formats; Rms and Std take the
+	root of the Q30 value, so a small spread of raw codes does not read 0 (Var is codes^2 / 32768).
+*/
+/* Get the array average */
+void Get_DataBuff_Mean_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result);
+void Get_DataBuff_Mean_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result);
+/* Gets the sum of squares in the array (Q15: 34.30, Q31: 16.48) */
+void Get_DataBuff_Power_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int64_t* p_Result);
+void Get_DataBuff_Power_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int64_t* p_Result);
+/* Gets the Root Mean Sqaure of the array */
+void Get_DataBuff_Rms_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result);
+void Get_DataBuff_Rms_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result);
+/* Gets the Standard deviation of the array */
+void Get_DataBuff_Std_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result);
+void Get_DataBuff_Std_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result);
+/* Get the array variance */
+void Get_DataBuff_Var_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result);
+void Get_DataBuff_Var_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result);
+/* Computes the maximum / minimum value of the data array and its position in the array */
+void Get_DataBuff_Max_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result, uint32_t* p_Index);
+void Get_DataBuff_Max_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result, uint32_t* p_Index);
+void Get_DataBuff_Min_Q15(int16_t* p_SrcBuff, uint32_t Buff_Size, int16_t* p_Result, uint32_t* p_Index);
+void Get_DataBuff_Min_Q31(int32_t* p_SrcBuff, uint32_t Buff_Size, int32_t* p_Result, uint32_t* p_Index);
+
+/* =====================================Frequency domain functions===================================== */
+
+/* Prepare the Hann window and the FFT tables of the spectrum analyzer */
+t_FuncRet Spectrum_Init(Spectrum_Analyzer* p_Spectrum, uint16_t FFT_Size, float32_t Sample_Rate);
+/* Window and transform FFT_Size samples, and compute the mean frequency, median frequency and band powers */
+t_FuncRet Spectrum_Get_Features(Spectrum_Analyzer* p_Spectrum, const float32_t* p_SrcBuff, 
+								const float32_t* p_Band_Edges, uint8_t Band_Num, Spectrum_Features* p_Features);
 
+/* Run the element-wise kernels and their scalar references on a test block, compare and count the cycles */
+t_FuncRet DataBuff_Kernel_Benchmark(DataBuff_Benchmark_Result* p_Result);
 /* Functions for testing digital signals */
 void DigtalSignal_Process_Test(void);
 
@@ -28,28 +28,69 @@ extern float Get_Yaxis_Angle_Acc(void);
 /* Return the Z-axis Angle_Acc */
 extern float Get_Zaxis_Angle_Acc(void);
 
-/* Mean filtering function */
-extern float Data_Mean_Filter_F(Mean_Filter_F* p_MeanFilterStruct,float Temp_Data_Buf[]);
-/* Mean filtering Reset function */
-extern void Mean_Filter_Rest_F(Mean_Filter_F* p_MeanFilterStruct);
+/* Return the timestamp of the latest angel packet */
+extern uint32_t Get_Angle_Timestamp(void);
+
+/* Initialize the moving average filter bank */
+extern t_FuncRet Moving_Average_Bank_Init_F(Moving_Average_Bank_F* p_Bank, uint32_t Channel_Num, uint16_t Window);
+/* One frame (one sample of every channel) is filtered by the moving average filter bank */
+extern void Moving_Average_Bank_Update_F(Moving_Average_Bank_F* p_Bank, const float* p_InData, float* p_OutData);
+/* Initialize the angle Kalman filter of one axis */
+extern t_FuncRet Kalman_Angle_Init(Kalman_Angle_Filter* p_Filter, float32_t Dt, float32_t Q_Angle, float32_t Q_Bias, float32_t R_Angle);
+/* Fuse one measured angle and angular rate by the angle Kalman filter */
+extern float32_t Kalman_Angle_Update(Kalman_Angle_Filter* p_Filter, float32_t Angle, float32_t Rate);
+/* Design the low pass of a polyphase resampler */
+extern t_FuncRet Polyphase_FIR_Design(uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, float32_t* p_Coeffs);
+/* Prepare a polyphase resampler and clear its delay line */
+extern t_FuncRet Polyphase_FIR_Init_F(Polyphase_FIR_F* p_Resampler, uint8_t Interpolation, uint8_t Decimation, uint16_t Phase_Taps, 
+									  const float32_t* p_Coeffs, float32_t* p_State);
+/* Resample a block of samples */
+extern uint32_t Polyphase_FIR_Process_F(Polyphase_FIR_F* p_Resampler, const float32_t* p_SrcBuff, uint32_t Stride, uint32_t Block_Size, float32_t* p_DstBuff);
 
 /* Serial port 6 The receiver is cleared periodically */
 extern t_FuncRet USART1_isRxComplete(void);
 
 /* Private macro definitions--------------------------------------------------*/
 
+/* Number of channels of the motion data: angle x/y/z, gyro x/y/z */
+#define MOTION_DATA_CHANNEL_NUM		6
+/* Number of axes fused by the angle Kalman filters */
+#define MOTION_DATA_AXIS_NUM		3
+/* Unwrapped angle beyond which one turn is taken out of the angle and the interpolator delay line, unit: deg */
+#define MOTION_DATA_UNWRAP_LIMIT	540.0f
+
 /* Global variable------------------------------------------------------------*/
 
-/* Cache array of the motion data collected by the gyroscope acquisition results */
-static float Angle_X_Buff[MEAN_FILTER_NUM];
-static float Angle_Y_Buff[MEAN_FILTER_NUM];
-static float Angle_Z_Buff[MEAN_FILTER_NUM];
-static float Gyro_X_Buff[MEAN_FILTER_NUM];
-static float Gyro_Y_Buff[MEAN_FILTER_NUM];
-static float Gyro_Z_Buff[MEAN_FILTER_NUM];
+/* Moving average filter bank of the motion data collected by the gyroscope */
+static Moving_Average_Bank_F MotionData_Filter_Bank;
+
+/* Determines whether the moving average filters are initialized */
+static bool MeanFilterInitFlag = (bool)FALSE;
+
+/* Angle Kalman filter of every axis */
+static Kalman_Angle_Filter MotionData_Kalman[MOTION_DATA_AXIS_NUM];
+
+/* Determines whether the angle Kalman filters are initialized */
+static bool KalmanFilterInitFlag = (bool)FALSE;
 
-/* Array index */
-static uint8_t DataBuf_Index = 0;
+/* Latest filtered motion data and the timestamp of the angel packet it ends with (unit: us) */
+static float    MotionData_Latest[6] = {0};
+static uint32_t MotionData_Timestamp = 0;
+/* Set when new motion data is filtered, cleared when it is read */
+static volatile bool MotionData_Ready_Flag = (bool)FALSE;
+
+/* Interpolators of every channel to MOTION_DATA_ALIGNED_RATE_HZ, one coefficient set shared by the channels */
+static Polyphase_FIR_F MotionData_Resampler[MOTION_DATA_CHANNEL_NUM];
+static float32_t       MotionData_Resampler_Coeffs[MOTION_DATA_ALIGNED_NUM*MOTION_DATA_ALIGNED_PHASE_TAPS];
+static float32_t       MotionData_Resampler_State[MOTION_DATA_CHANNEL_NUM][2*MOTION_DATA_ALIGNED_PHASE_TAPS];
+/* Determines whether the interpolators are initialized */
+static bool ResamplerInitFlag = (bool)FALSE;
+/* Angles fed to the interpolators without the -180 ~ 180 deg wrap, unit: deg */
+static float    MotionData_Unwrapped[MOTION_DATA_AXIS_NUM] = {0};
+/* Resampled samples of the latest reading and whether they have been read */
+static float    MotionData_Aligned[MOTION_DATA_CHANNEL_NUM][MOTION_DATA_ALIGNED_NUM];
+static uint32_t MotionData_Aligned_Num[MOTION_DATA_CHANNEL_NUM] = {0};
+static volatile bool MotionData_Aligned_Ready[MOTION_DATA_CHANNEL_NUM] = {(bool)FALSE};
 
 /* count variable */
 
@@ -57,6 +98,8 @@ static uint8_t DataBuf_Index = 0;
 
 /* Static function definition-------------------------------------------------*/
 
+/* Keep one filtered frame for the main loop and resample it to MOTION_DATA_ALIGNED_RATE_HZ */
+static void MotionData_Store(const float* p_Frame);
 
 /* Function definition--------------------------------------------------------*/
 
@@ -80,59 +123,268 @@ t_FuncRet Get_MotionData_MeanFilter_Value(float* p_angle_x ,
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	/* Initializes the filter structure */
-	Mean_Filter_F FilterStruct = {0};
-		
-	/* Index Value Judgment */
-	if(DataBuf_Index >= (MEAN_FILTER_NUM-1))
+	float Frame_In[MOTION_DATA_CHANNEL_NUM];
+	float Frame_Out[MOTION_DATA_CHANNEL_NUM];
+	
+	/* Initializes the filter bank once, the history is kept between calls */
+	if(MeanFilterInitFlag == (bool)FALSE)
 	{
-		DataBuf_Index = 0;
+		Moving_Average_Bank_Init_F(&MotionData_Filter_Bank, MOTION_DATA_CHANNEL_NUM, MEAN_FILTER_NUM);
+		MeanFilterInitFlag = (bool)TRUE;
 	}
-	else
+	
+	/* Put the collected data into one frame */
+	Frame_In[0] = Get_Xaxis_Angle();
+	Frame_In[1] = Get_Yaxis_Angle();
+	Frame_In[2] = Get_Zaxis_Angle();
+	
+	Frame_In[3] = Get_Xaxis_Angle_Acc();
+	Frame_In[4] = Get_Yaxis_Angle_Acc();
+	Frame_In[5] = Get_Zaxis_Angle_Acc();
+	
+	/* Mean filtering, all channels of the frame in one call */
+	Moving_Average_Bank_Update_F(&MotionData_Filter_Bank, Frame_In, Frame_Out);
+	
+	*p_angle_x = Frame_Out[0];
+	*p_angle_y = Frame_Out[1];
+	*p_angle_z = Frame_Out[2];
+	
+	*p_gyro_x  = Frame_Out[3];
+	*p_gyro_y  = Frame_Out[4];
+	*p_gyro_z  = Frame_Out[5];
+	
+	/* Keep the result and its timestamp for the sending in the main loop */
+	MotionData_Store(Frame_Out);
+	
+	return ret;
+}
+
+/** 
+* @description: Get the motion data fused by the angle Kalman filters: the angle of every axis is predicted by
+*				its angular rate and corrected by the measured angle, the rate is returned with the estimated bias removed
+* @param  {float*}  p_angle_x : Data after filtering, unit: deg
+* @param  {float*}  p_angle_y : Data after filtering, unit: deg
+* @param  {float*}  p_angle_z : Data after filtering, unit: deg
+* @param  {float*}  p_gyro_x  : Data after filtering, unit: deg/s
+* @param  {float*}  p_gyro_y  : Data after filtering, unit: deg/s
+* @param  {float*}  p_gyro_z  : Data after filtering, unit: deg/s
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Get_MotionData_Kalman_Value(float* p_angle_x , 
+									  float* p_angle_y ,
+									  float* p_angle_z ,
+									  float* p_gyro_x  ,
+									  float* p_gyro_y  ,
+									  float* p_gyro_z )
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	float Frame_In[MOTION_DATA_CHANNEL_NUM];
+	float Frame_Out[MOTION_DATA_CHANNEL_NUM];
+	
+	/* Initializes the filters once, the state is kept between calls */
+	if(KalmanFilterInitFlag == (bool)FALSE)
 	{
-		DataBuf_Index++;
+		for(uint8_t axis = 0; axis < MOTION_DATA_AXIS_NUM; axis++)
+		{
+			Kalman_Angle_Init(&MotionData_Kalman[axis], 1.0f/MOTION_DATA_RATE_HZ, 
+							  MOTION_KALMAN_Q_ANGLE, MOTION_KALMAN_Q_BIAS, MOTION_KALMAN_R_ANGLE);
+		}
+		KalmanFilterInitFlag = (bool)TRUE;
 	}
 	
-	/* Put the collected data into the cache array */
-	Angle_X_Buff[DataBuf_Index] = Get_Xaxis_Angle();
-	Angle_Y_Buff[DataBuf_Index] = Get_Yaxis_Angle();
-	Angle_Z_Buff[DataBuf_Index] = Get_Zaxis_Angle();
+	/* Put the collected data into one frame */
+	Frame_In[0] = Get_Xaxis_Angle();
+	Frame_In[1] = Get_Yaxis_Angle();
+	Frame_In[2] = Get_Zaxis_Angle();
 	
-	Gyro_X_Buff[DataBuf_Index]  = Get_Xaxis_Angle_Acc();
-	Gyro_Y_Buff[DataBuf_Index]  = Get_Yaxis_Angle_Acc();
-	Gyro_Z_Buff[DataBuf_Index]  = Get_Zaxis_Angle_Acc();
+	Frame_In[3] = Get_Xaxis_Angle_Acc();
+	Frame_In[4] = Get_Yaxis_Angle_Acc();
+	Frame_In[5] = Get_Zaxis_Angle_Acc();
 	
-	/* Mean filtering */
-	*p_angle_x = Data_Mean_Filter_F((Mean_Filter_F*)&FilterStruct ,Angle_X_Buff);
-	Mean_Filter_Rest_F((Mean_Filter_F*)&FilterStruct);
+	/* Every axis fuses its angle and its angular rate */
+	for(uint8_t axis = 0; axis < MOTION_DATA_AXIS_NUM; axis++)
+	{
+		Frame_Out[axis] = Kalman_Angle_Update(&MotionData_Kalman[axis], Frame_In[axis], Frame_In[axis + MOTION_DATA_AXIS_NUM]);
+		Frame_Out[axis + MOTION_DATA_AXIS_NUM] = Frame_In[axis + MOTION_DATA_AXIS_NUM] - MotionData_Kalman[axis].State[1];
+	}
 	
-	*p_angle_y = Data_Mean_Filter_F((Mean_Filter_F*)&FilterStruct ,Angle_Y_Buff);
-	Mean_Filter_Rest_F((Mean_Filter_F*)&FilterStruct);
+	*p_angle_x = Frame_Out[0];
+	*p_angle_y = Frame_Out[1];
+	*p_angle_z = Frame_Out[2];
 	
-	*p_angle_z = Data_Mean_Filter_F((Mean_Filter_F*)&FilterStruct ,Angle_Z_Buff);
-	Mean_Filter_Rest_F((Mean_Filter_F*)&FilterStruct);
+	*p_gyro_x  = Frame_Out[3];
+	*p_gyro_y  = Frame_Out[4];
+	*p_gyro_z  = Frame_Out[5];
 	
-	*p_gyro_x  = Data_Mean_Filter_F((Mean_Filter_F*)&FilterStruct ,Gyro_X_Buff);
-	Mean_Filter_Rest_F((Mean_Filter_F*)&FilterStruct);
+	/* Keep the result and its timestamp for the sending in the main loop */
+	MotionData_Store(Frame_Out);
 	
-	*p_gyro_y  = Data_Mean_Filter_F((Mean_Filter_F*)&FilterStruct ,Gyro_Y_Buff);
-	Mean_Filter_Rest_F((Mean_Filter_F*)&FilterStruct);
+	return ret;
+}
+
+/** 
+* @description: Obtain the latest filtered motion data with its timestamp, called in the main loop
+* @param  {float*}     p_angle_x   : Data after filtering
+* @param  {float*}     p_angle_y   : Data after filtering
+* @param  {float*}     p_gyro_x    : Data after filtering
+* @param  {float*}     p_gyro_y    : Data after filtering
+* @param  {uint32_t*}  p_Timestamp : Timestamp of the latest angel packet, unit: us
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no new data was filtered
+* @author: leeqingshui 
+*/
+t_FuncRet Get_MotionData_Latest(float* p_angle_x ,
+								float* p_angle_y ,
+								float* p_gyro_x  ,
+								float* p_gyro_y  ,
+								uint32_t* p_Timestamp)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	*p_gyro_z  = Data_Mean_Filter_F((Mean_Filter_F*)&FilterStruct ,Gyro_Z_Buff);
-	Mean_Filter_Rest_F((Mean_Filter_F*)&FilterStruct);
+	if(MotionData_Ready_Flag == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
 	
-	/* Result back on the array */
-	Angle_X_Buff[DataBuf_Index] =  *p_angle_x;
-	Angle_Y_Buff[DataBuf_Index] =  *p_angle_y;
-	Angle_Z_Buff[DataBuf_Index] =  *p_angle_z;
+	/* The data is written in the timer 4 interrupt */
+	__disable_irq();
+	*p_angle_x   = MotionData_Latest[0];
+	*p_angle_y   = MotionData_Latest[1];
+	*p_gyro_x    = MotionData_Latest[3];
+	*p_gyro_y    = MotionData_Latest[4];
+	*p_Timestamp = MotionData_Timestamp;
+	MotionData_Ready_Flag = (bool)FALSE;
+	__enable_irq();
 	
-	Gyro_X_Buff[DataBuf_Index]  =  *p_gyro_x ;
-	Gyro_Y_Buff[DataBuf_Index]  =  *p_gyro_y;
-	Gyro_Z_Buff[DataBuf_Index]  =  *p_gyro_z;
-
 	return ret;
 }
 
+/** 
+* @description: Obtain one channel of the latest motion data resampled to MOTION_DATA_ALIGNED_RATE_HZ, called in the main loop.
+*				The interpolator delays the data by MOTION_DATA_ALIGNED_PHASE_TAPS/2 readings, the angles are in -180 ~ 180 deg
+* @param  {uint8_t}    Channel   : 0 - 5: angle x, angle y, angle z, gyro x, gyro y, gyro z
+* @param  {float*}     p_DstBuff : Resampled data, MOTION_DATA_ALIGNED_NUM samples at most
+* @param  {uint32_t*}  p_Num     : Number of resampled samples
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no new data was filtered
+* @author: leeqingshui 
+*/
+t_FuncRet Get_MotionData_Aligned(uint8_t Channel, float* p_DstBuff, uint32_t* p_Num)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(Channel >= MOTION_DATA_CHANNEL_NUM)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	if(MotionData_Aligned_Ready[Channel] == (bool)FALSE)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	/* The data is written in the timer 4 interrupt */
+	__disable_irq();
+	*p_Num = MotionData_Aligned_Num[Channel];
+	for(uint32_t i = 0; i < MotionData_Aligned_Num[Channel]; i++)
+	{
+		p_DstBuff[i] = MotionData_Aligned[Channel][i];
+	}
+	MotionData_Aligned_Ready[Channel] = (bool)FALSE;
+	__enable_irq();
+	
+	return ret;
+}
 
+/** 
+* @description: Keep one filtered frame and its timestamp for the main loop and resample it to MOTION_DATA_ALIGNED_RATE_HZ,
+*				every reading gives MOTION_DATA_ALIGNED_NUM samples per channel at the rate of the EMG.
+*				The angles are interpolated unwrapped and wrapped again afterwards, a crossing of 180 deg
+*				would otherwise be interpolated through 0 deg
+* @param  {float*}  p_Frame : Angle x/y/z and gyro x/y/z
+* @return {void} 
+* @author: leeqingshui 
+*/
+static void MotionData_Store(const float* p_Frame)
+{
+	float Frame_In[MOTION_DATA_CHANNEL_NUM];
+	
 
-
+	MotionData_Latest[0]  = p_Frame[0];
+	MotionData_Latest[1]  = p_Frame[1];
+	MotionData_Latest[2]  = p_Frame[2];
+	MotionData_Latest[3]  = p_Frame[3];
+	MotionData_Latest[4]  = p_Frame[4];
+	MotionData_Latest[5]  = p_Frame[5];
+	MotionData_Timestamp  = Get_Angle_Timestamp();
+	MotionData_Ready_Flag = (bool)TRUE;
+	
+	if(ResamplerInitFlag == (bool)FALSE)
+	{
+		Polyphase_FIR_Design(MOTION_DATA_ALIGNED_NUM, 1, MOTION_DATA_ALIGNED_PHASE_TAPS, MotionData_Resampler_Coeffs);
+		for(uint8_t ch = 0; ch < MOTION_DATA_CHANNEL_NUM; ch++)
+		{
+			Polyphase_FIR_Init_F(&MotionData_Resampler[ch], MOTION_DATA_ALIGNED_NUM, 1, MOTION_DATA_ALIGNED_PHASE_TAPS, 
+								 MotionData_Resampler_Coeffs, MotionData_Resampler_State[ch]);
+		}
+		for(uint8_t axis = 0; axis < MOTION_DATA_AXIS_NUM; axis++)
+		{
+			MotionData_Unwrapped[axis] = p_Frame[axis];
+		}
+		ResamplerInitFlag = (bool)TRUE;
+	}
+	
+	/* Every angle moves by the short way round from the previous reading */
+	for(uint8_t axis = 0; axis < MOTION_DATA_AXIS_NUM; axis++)
+	{
+		float Step = p_Frame[axis] - MotionData_Unwrapped[axis];
+		
+		while(Step >= 180.0f)
+		{
+			Step = Step - 360.0f;
+		}
+		while(Step < -180.0f)
+		{
+			Step = Step + 360.0f;
+		}
+		MotionData_Unwrapped[axis] = MotionData_Unwrapped[axis] + Step;
+		
+		/* Whole turns are taken out of the angle and its delay line together, every phase has a DC gain of 1 */
+		if((MotionData_Unwrapped[axis] >= MOTION_DATA_UNWRAP_LIMIT) || (MotionData_Unwrapped[axis] < -MOTION_DATA_UNWRAP_LIMIT))
+		{
+			float Turn = (MotionData_Unwrapped[axis] > 0) ? 360.0f : -360.0f;
+			
+			MotionData_Unwrapped[axis] = MotionData_Unwrapped[axis] - Turn;
+			for(uint32_t i = 0; i < 2*MOTION_DATA_ALIGNED_PHASE_TAPS; i++)
+			{
+				MotionData_Resampler_State[axis][i] = MotionData_Resampler_State[axis][i] - Turn;
+			}
+		}
+		Frame_In[axis] = MotionData_Unwrapped[axis];
+	}
+	for(uint8_t ch = MOTION_DATA_AXIS_NUM; ch < MOTION_DATA_CHANNEL_NUM; ch++)
+	{
+		Frame_In[ch] = p_Frame[ch];
+	}
+	
+	for(uint8_t ch = 0; ch < MOTION_DATA_CHANNEL_NUM; ch++)
+	{
+		MotionData_Aligned_Num[ch]   = Polyphase_FIR_Process_F(&MotionData_Resampler[ch], &Frame_In[ch], 1, 1, MotionData_Aligned[ch]);
+		MotionData_Aligned_Ready[ch] = (bool)TRUE;
+	}
+	
+	for(uint8_t axis = 0; axis < MOTION_DATA_AXIS_NUM; axis++)
+	{
+		for(uint32_t i = 0; i < MotionData_Aligned_Num[axis]; i++)
+		{
+			while(MotionData_Aligned[axis][i] >= 180.0f)
+			{
+				MotionData_Aligned[axis][i] = MotionData_Aligned[axis][i] - 360.0f;
+			}
+			while(MotionData_Aligned[axis][i] < -180.0f)
+			{
+				MotionData_Aligned[axis][i] = MotionData_Aligned[axis][i] + 360.0f;
+			}
+		}
+	}
+}
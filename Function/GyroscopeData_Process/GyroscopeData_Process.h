@@ -18,6 +18,23 @@
 
 /* Common macro definitions---------------------------------------------------*/
 
+/* Rate the motion data are read at by timer 4, unit: Hz */
+#define MOTION_DATA_RATE_HZ             20
+/* Common rate the motion data are resampled to, the same as ADC_EMG_ALIGNED_RATE_HZ, unit: Hz */
+#define MOTION_DATA_ALIGNED_RATE_HZ     500
+/* Taps of every phase of the motion data interpolator */
+#define MOTION_DATA_ALIGNED_PHASE_TAPS  8
+/* Number of resampled samples produced by one reading of the motion data */
+#define MOTION_DATA_ALIGNED_NUM         (MOTION_DATA_ALIGNED_RATE_HZ / MOTION_DATA_RATE_HZ)
+
+/* 
+    Noise of the angle Kalman filters for one reading period: angle and gyro bias process noise (deg^2, (deg/s)^2),
+    angle measurement noise (deg^2). A larger R follows the gyro more and the measured angle less
+*/
+#define MOTION_KALMAN_Q_ANGLE           0.001f
+#define MOTION_KALMAN_Q_BIAS            0.003f
+#define MOTION_KALMAN_R_ANGLE           0.03f
+
 /* Data structure declaration-------------------------------------------------*/
 
 /* Extern variables-----------------------------------------------------------*/
@@ -32,6 +49,24 @@ t_FuncRet Get_MotionData_MeanFilter_Value(float* p_angle_x ,
 								          float* p_gyro_y  ,
                                           float* p_gyro_z );
 
+/* Get the motion data fused by the angle Kalman filters */
+t_FuncRet Get_MotionData_Kalman_Value(float* p_angle_x , 
+                                      float* p_angle_y ,
+                                      float* p_angle_z ,
+                                      float* p_gyro_x  ,
+                                      float* p_gyro_y  ,
+                                      float* p_gyro_z );
+
+/* Obtain the latest filtered motion data with its timestamp */
+t_FuncRet Get_MotionData_Latest(float* p_angle_x ,
+                                float* p_angle_y ,
+                                float* p_gyro_x  ,
+                                float* p_gyro_y  ,
+                                uint32_t* p_Timestamp);
+
+/* Obtain one channel of the latest motion data resampled to MOTION_DATA_ALIGNED_RATE_HZ */
+t_FuncRet Get_MotionData_Aligned(uint8_t Channel, float* p_DstBuff, uint32_t* p_Num);
+
 
 #ifdef __cplusplus
 }
@@ -9,24 +9,126 @@
 #include "SendData_Function.h"
 #include "usbd_cdc_if.h"
 #include "numtype.h"
+#include "ADC_Operation.h"
+#include "ADC_Function.h"
+#include "GyroscopeData_Process.h"
+#include "ServoMotor_Control.h"
+#include "math.h"
 
 /* External function declaration----------------------------------------------*/
 
 
 /* Private macro definitions--------------------------------------------------*/
 
-/* Serial port send macro definition */
-#define DataWrite  CDC_Transmit_FS
+/* Serial port send macro definition: the data is copied into the CDC transmit queue and sent in the background */
+#define DataWrite  CDC_Transmit_Queue_FS
+
+/* Time to wait for the ack signal before the sync signal is sent again, unit: ms */
+#define ACK_SIGNAL_TIMEOUT                  10
+
+/* Bytes of the largest batch */
+#define ADC_BATCH_BUF_SIZE                  ADC_BATCH_SIZE(ADC_BATCH_FRAME_NUM)
+
+#if((ADC_BATCH_FRAME_NUM < 1) || (ADC_BATCH_FRAME_NUM > 255) || (ADC_BATCH_BUF_SIZE > CDC_TX_SLOT_SIZE))
+	#error "ADC_BATCH_FRAME_NUM must be 1 - 255 and the batch must fit in a slot of the CDC transmit queue"
+#endif
+#if(ADC_BATCH_CHANNEL_NUM != (SAMPLE_FRAME_CHANNEL_NUM + 1))
+	#error "A batch frame holds the channels of a sample frame and Vref"
+#endif
+
+/* States of the command frame parser: the next byte expected */
+#define COMMAND_PARSE_HEADER1               0
+#define COMMAND_PARSE_HEADER2               1
+#define COMMAND_PARSE_CMD                   2
+#define COMMAND_PARSE_LEN                   3
+#define COMMAND_PARSE_PAYLOAD               4
+#define COMMAND_PARSE_CRC_H                 5
+#define COMMAND_PARSE_CRC_L                 6
+
+/* Bytes of a reply frame before the payload and after the payload */
+#define COMMAND_REPLY_HEAD_SIZE             6
+#define COMMAND_REPLY_TAIL_SIZE             3
 
 /* Global variable------------------------------------------------------------*/
 
-/* Synchronization signal received flag bit */
-bool AckSignalRecvFlag  = (bool)FALSE;
-/* USB virtual serial port receiving flag bit */
-bool USBRecvSuccessFlag = (bool)FALSE;
+/* Synchronization signal received flag bit, set in the USB interrupt */
+volatile bool AckSignalRecvFlag  = (bool)FALSE;
+/* USB virtual serial port receiving flag bit, set in the USB interrupt */
+volatile bool USBRecvSuccessFlag = (bool)FALSE;
+/* Number of frames granted by the credit signals since power on, set in the USB interrupt */
+volatile uint32_t StreamCreditGranted = 0;
+/* Whether a credit signal has been received, the batches are then sent without the handshake */
+static volatile bool StreamCreditMode = (bool)FALSE;
+/* Number of granted frames already sent, only written in the main loop: the credit left is the difference */
+static uint32_t StreamCreditUsed = 0;
+/* Encoding of the batched ADC stream requested by the upper computer, set in the USB interrupt */
+static volatile uint8_t StreamEncoding = STREAM_ENCODING_RAW;
+/* Streams sent by the main loop, STREAM_SELECT_xxx bits */
+static uint8_t StreamSelect = STREAM_SELECT_ALL;
+
+/* A sync signal was sent and its ack signal has not arrived yet */
+static bool     SyncSignalPending = (bool)FALSE;
+/* Time the last sync signal was sent, unit: ms */
+static uint32_t SyncSignalTick    = 0;
+/* Frame taken out of the sample ring and waiting to be sent */
+static Sample_Frame StreamFrame;
+static bool         StreamFrameValid  = (bool)FALSE;
+
+/* 
+    Batch buffer: the transmit queue copies the batch, so it is built again as soon as it is queued.
+    The length of the batch built in it (0 if none) and its number of frames
+*/
+static uint8_t  ADC_Batch_Buf[ADC_BATCH_BUF_SIZE];
+static uint16_t ADC_Batch_Len      = 0;
+static uint16_t ADC_Batch_FrameNum = 0;
+/* Frames per batch and longest wait for a full batch (unit: ms), set by the upper computer */
+static uint16_t ADC_Batch_FrameMax = ADC_BATCH_FRAME_NUM;
+static uint32_t ADC_Batch_Timeout  = ADC_BATCH_TIMEOUT;
+/* Time the ring was first seen not empty while a batch was not full yet, unit: ms */
+static uint32_t ADC_Batch_WaitTick  = 0;
+static bool     ADC_Batch_WaitValid = (bool)FALSE;
+/* Frame taken out of the ring after a gap in the sample index, it starts the next batch */
+static Sample_Frame ADC_Batch_NextFrame;
+static bool         ADC_Batch_NextValid = (bool)FALSE;
+
+/* CRC16-CCITT remainders of the 16 values of a nibble */
+static const uint16_t CRC16_CCITT_Table[16] = 
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/* 
+    Command frame parser, only run in the USB interrupt: its state is kept between packets 
+    so that a frame split across packets is put together again
+*/
+static uint8_t       Command_Parse_State = COMMAND_PARSE_HEADER1;
+static uint8_t       Command_Parse_Index = 0;
+/* Time the last packet went through the parser, unit: ms */
+static uint32_t      Command_Parse_Tick  = 0;
+static uint16_t      Command_Parse_Crc   = 0;
+static Command_Frame Command_Parse_Frame;
+/* 
+    Received commands: written in the USB interrupt at Command_Queue_Tail, 
+    read in the main loop at Command_Queue_Head, one slot is kept empty
+*/
+static Command_Frame    Command_Queue[COMMAND_QUEUE_NUM + 1];
+static volatile uint8_t Command_Queue_Head = 0;
+static volatile uint8_t Command_Queue_Tail = 0;
+/* Number of commands received and of command frames rejected */
+static volatile uint32_t Command_Recv_Count  = 0;
+static volatile uint32_t Command_Error_Count = 0;
 
 /* Static function definition-------------------------------------------------*/
 
+/* Build one batch from the frames of the ADC sample ring */
+static uint16_t ADC_Batch_Build(uint8_t* p_Buf, uint16_t Max_Frame_Num, uint8_t Encoding, uint16_t* p_Frame_Num);
+/* Feed one received byte to the command frame parser */
+static void Command_Parse_Byte(uint8_t Data);
+/* Execute one command and fill in the payload of its reply */
+static uint8_t Command_Execute(const Command_Frame* p_Cmd, uint8_t* p_Reply, uint8_t* p_Reply_Len);
+/* Send a reply frame to PC */
+static t_FuncRet SendCommandReplyToPC(uint8_t Cmd, uint8_t Status, const uint8_t* p_Payload, uint8_t Len);
 
 /* Function definition--------------------------------------------------------*/
 
@@ -94,14 +196,17 @@ t_FuncRet AckSignal_Recv(uint8_t* Buf)
 * @param   {uint8_t} DataType : Incoming data type
 *                               ADC_TYPE (0) -Datax The data type is float
 *                               GYROSCOPE_TYPE (1) -Datax The data type is uint16
+*                               SAMPLE_PROFILE_TYPE (2) -Datax The data type is uint16
+*                               SPECTRUM_TYPE (3), SPECTRUM_BAND_TYPE (4) -Datax The data type is uint16
 * @param   {void*}   Datax    : Data that needs to be sent and whose data type is uncertain
+* @param   {uint32_t} Timestamp : Acquisition time of the data, unit: us
 * @return  {t_FuncRet}        : if success , return (t_FuncRet)Operation_Success
 * @example :
-*           SendDataToPC(ADC_TYPE, (void*)&Sensor1_V_Data, (void*)&Sensor2_V_Data, (void*)&Sensor3_V_Data, (void*)&Sensor4_V_Data);
-*           SendDataToPC(GYROSCOPE_TYPE, (void*)&angle_x, (void*)&angle_y, (void*)&gyro_x, (void*)&gyro_y);
+*           SendDataToPC(ADC_TYPE, (void*)&Sensor1_V_Data, (void*)&Sensor2_V_Data, (void*)&Sensor3_V_Data, (void*)&Sensor4_V_Data, Frame.Timestamp);
+*           SendDataToPC(GYROSCOPE_TYPE, (void*)&angle_x, (void*)&angle_y, (void*)&gyro_x, (void*)&gyro_y, Get_Angle_Timestamp());
 * @author: leeqingshui 
 */
-t_FuncRet SendDataToPC(uint8_t DataType, void* Data0, void* Data1, void* Data2, void* Data3)
+t_FuncRet SendDataToPC(uint8_t DataType, void* Data0, void* Data1, void* Data2, void* Data3, uint32_t Timestamp)
 {
     t_FuncRet ret = Operation_Success;
     
@@ -121,6 +226,11 @@ t_FuncRet SendDataToPC(uint8_t DataType, void* Data0, void* Data1, void* Data2,
         SendDataStruct.DataType     = (uint8_t)DataType;
         SendDataStruct.Stop         = (uint8_t)FRAME_STOP;
         
+        SendDataStruct.Timestamp3   = (uint8_t)(Timestamp >> 24);
+        SendDataStruct.Timestamp2   = (uint8_t)(Timestamp >> 16);
+        SendDataStruct.Timestamp1   = (uint8_t)(Timestamp >> 8);
+        SendDataStruct.Timestamp0   = (uint8_t)(Timestamp);
+        
         /* The gyroscope output Angle and angular velocity data of the data type float32_t */
         if(DataType == GYROSCOPE_TYPE)
         {
@@ -160,7 +270,8 @@ t_FuncRet SendDataToPC(uint8_t DataType, void* Data0, void* Data1, void* Data2,
             SendDataStruct.Data3_H = GET_HIGH_BYTE(u16_temp_data3);
             SendDataStruct.Data3_L = GET_LOW_BYTE(u16_temp_data3);
         }
-        else if(DataType == ADC_TYPE)
+        else if((DataType == ADC_TYPE) || (DataType == SAMPLE_PROFILE_TYPE) || 
+                (DataType == SPECTRUM_TYPE) || (DataType == SPECTRUM_BAND_TYPE))
         {
             u16_temp_data0 = (uint16_t)(*((uint16_t*)Data0));
             u16_temp_data1 = (uint16_t)(*((uint16_t*)Data1));
@@ -192,4 +303,812 @@ t_FuncRet SendDataToPC(uint8_t DataType, void* Data0, void* Data1, void* Data2,
     return ret;
 }
 
+/** 
+* @description                : Sampling profile switch signal reception function
+*                               | 0x58 | Profile number |
+*                               It is called by CDC_Receive_FS function in usbd_cdc_if.c file,
+*                               the switch itself is done later in the main loop by ADC_SampleProfile_Process
+* @param   {uint8_t*} Buf     : USB Data received by the virtual serial port
+* @param   {uint32_t} Len     : Number of data received
+* @return  {t_FuncRet}        : If the received data is a correct switch signal, return (t_FuncRet)Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet SampleProfile_Recv(uint8_t* Buf, uint32_t Len)
+{
+    t_FuncRet ret = Operation_Success;
+    
+    if((Len < 2) || (Buf[0] != SAMPLE_PROFILE_SIGNAL))
+    {
+        ret = Operation_Fail;
+    }
+    else
+    {
+        ret = ADC_Request_SampleProfile(Buf[1]);
+    }
+    
+    return ret;
+}
+
+/** 
+* @description                : Credit signal reception function
+*                               | 0x59 | CREDIT_H | CREDIT_L |
+*                               It is called by CDC_Receive_FS function in usbd_cdc_if.c file. 
+*                               The credit is only added here and only used in the main loop, so no lock is needed
+* @param   {uint8_t*} Buf     : USB Data received by the virtual serial port
+* @param   {uint32_t} Len     : Number of data received
+* @return  {t_FuncRet}        : If the received data is a correct credit signal, return (t_FuncRet)Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet Credit_Recv(uint8_t* Buf, uint32_t Len)
+{
+    t_FuncRet ret = Operation_Success;
+    
+    if((Len < 3) || (Buf[0] != CREDIT_SIGNAL))
+    {
+        ret = Operation_Fail;
+    }
+    else
+    {
+        StreamCreditGranted = StreamCreditGranted + BYTE_TO_HW(Buf[1], Buf[2]);
+        StreamCreditMode    = (bool)TRUE;
+    }
+    
+    return ret;
+}
+
+/** 
+* @description                : Stream encoding signal reception function
+*                               | 0x5B | Encoding |
+*                               It is called by CDC_Receive_FS function in usbd_cdc_if.c file,
+*                               the batch being sent keeps its encoding and the next one is built with the new one
+* @param   {uint8_t*} Buf     : USB Data received by the virtual serial port
+* @param   {uint32_t} Len     : Number of data received
+* @return  {t_FuncRet}        : If the received data is a correct encoding signal, return (t_FuncRet)Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet StreamEncoding_Recv(uint8_t* Buf, uint32_t Len)
+{
+    t_FuncRet ret = Operation_Success;
+    
+    if((Len < 2) || (Buf[0] != STREAM_ENCODING_SIGNAL) || 
+       ((Buf[1] != STREAM_ENCODING_RAW) && (Buf[1] != STREAM_ENCODING_DELTA)))
+    {
+        ret = Operation_Fail;
+    }
+    else
+    {
+        StreamEncoding = Buf[1];
+    }
+    
+    return ret;
+}
+
+/** 
+* @description                : Command frame reception function
+*                               It is called by CDC_Receive_FS function in usbd_cdc_if.c file for every packet.
+*                               The bytes go through the command frame parser, complete frames are queued 
+*                               for Command_Process in the main loop. A frame left open for COMMAND_PARSE_TIMEOUT
+*                               (its last packet lost) is dropped, so that the next packets are read as signals again
+* @param   {uint8_t*} Buf     : USB Data received by the virtual serial port
+* @param   {uint32_t} Len     : Number of data received
+* @return  {t_FuncRet}        : Operation_Fail if the packet is not part of a command frame, 
+*                               it is then a single byte signal
+* @author: leeqingshui 
+*/
+t_FuncRet Command_Recv(uint8_t* Buf, uint32_t Len)
+{
+    t_FuncRet ret = Operation_Success;
+    
+    if(Len == 0)
+    {
+        return ret = Operation_Fail;
+    }
+    /* The rest of the open frame never came */
+    if((Command_Parse_State != COMMAND_PARSE_HEADER1) && ((HAL_GetTick() - Command_Parse_Tick) > COMMAND_PARSE_TIMEOUT))
+    {
+        Command_Parse_State = COMMAND_PARSE_HEADER1;
+        Command_Error_Count++;
+    }
+    /* No frame is open and the packet does not go on with a header: it is a single byte signal */
+    if(((Command_Parse_State == COMMAND_PARSE_HEADER1) && (Buf[0] != COMMAND_HEADER1)) || 
+       ((Command_Parse_State == COMMAND_PARSE_HEADER2) && (Buf[0] != COMMAND_HEADER1) && (Buf[0] != COMMAND_HEADER2)))
+    {
+        Command_Parse_State = COMMAND_PARSE_HEADER1;
+        return ret = Operation_Fail;
+    }
+    
+    for(uint32_t i = 0; i < Len; i++)
+    {
+        Command_Parse_Byte(Buf[i]);
+    }
+    Command_Parse_Tick = HAL_GetTick();
+    
+    return ret;
+}
+
+/** 
+* @description                : Execute the commands received from the upper computer and answer each of them, 
+*                               called in the main loop. A command is executed once: if its reply cannot be queued
+*                               it is lost, the upper computer then sees no reply and can read the stats
+* @param   {void}    
+* @return  {t_FuncRet}        : Operation_Success if a command was executed, Operation_Wait if none is waiting
+* @author: leeqingshui 
+*/
+t_FuncRet Command_Process(void)
+{
+    t_FuncRet ret = Operation_Wait;
+    
+    uint8_t Reply[COMMAND_PAYLOAD_MAX];
+    uint8_t Reply_Len, Status;
+    
+    while(Command_Queue_Head != Command_Queue_Tail)
+    {
+        Status = Command_Execute(&Command_Queue[Command_Queue_Head], Reply, &Reply_Len);
+        SendCommandReplyToPC(Command_Queue[Command_Queue_Head].Cmd, Status, Reply, Reply_Len);
+        
+        Command_Queue_Head = (uint8_t)((Command_Queue_Head + 1) % (COMMAND_QUEUE_NUM + 1));
+        ret = Operation_Success;
+    }
+    
+    return ret;
+}
+
+/** 
+* @description                : Report the current sampling profile and the achieved sampling rate to PC
+*                               Data0 - Profile number, Data1/Data2 - Sampling rate high/low 16 bits (Hz), 
+*                               Data3 - Number of frames in one DMA block
+* @param   {void}    
+* @return  {t_FuncRet}        : if success , return (t_FuncRet)Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet SendSampleProfileToPC(void)
+{
+    uint32_t Sample_Rate  = ADC_Get_SampleRate();
+    
+    uint16_t Profile_ID   = (uint16_t)ADC_Get_SampleProfile();
+    uint16_t Rate_High    = (uint16_t)(Sample_Rate >> 16);
+    uint16_t Rate_Low     = (uint16_t)(Sample_Rate);
+    uint16_t Frame_Num    = (uint16_t)ADC_Get_BlockFrameNum();
+    
+    return SendDataToPC(SAMPLE_PROFILE_TYPE, (void*)&Profile_ID, (void*)&Rate_High, (void*)&Rate_Low, (void*)&Frame_Num, 
+                        GET_TIMESTAMP_US());
+}
+
+/** 
+* @description                : Send the frames of the ADC sample ring to PC, called in the main loop
+*                               Every frame keeps the sync/ack handshake: STM32 sends the sync signal,
+*                               after the upper computer answers with the ack signal one frame is sent.
+*                               The ADC interrupt only fills the ring, so a slow USB transfer makes the
+*                               ring grow (or overrun, counted) instead of stalling the acquisition
+* @param   {void}    
+* @return  {t_FuncRet}        : Operation_Success if a frame was sent, Operation_Wait if nothing was sent
+* @author: leeqingshui 
+*/
+t_FuncRet SendADCStreamToPC(void)
+{
+    t_FuncRet ret = Operation_Wait;
+    
+    /* Keep one frame at hand, it is only dropped after it has been sent */
+    if(StreamFrameValid == (bool)FALSE)
+    {
+        if(Get_ADC_Frame(&StreamFrame) == Operation_Success)
+        {
+            StreamFrameValid = (bool)TRUE;
+        }
+        else
+        {
+            return ret;
+        }
+    }
+    
+    /* The upper computer acknowledged the last sync signal: send the frame */
+    if(AckSignalRecvFlag != (bool)FALSE)
+    {
+        if(SendDataToPC(ADC_TYPE, (void*)&StreamFrame.Data[0], (void*)&StreamFrame.Data[1], 
+                                  (void*)&StreamFrame.Data[2], (void*)&StreamFrame.Data[3], 
+                                  StreamFrame.Timestamp) == Operation_Success)
+        {
+            AckSignalRecvFlag = (bool)FALSE;
+            SyncSignalPending = (bool)FALSE;
+            StreamFrameValid  = (bool)FALSE;
+            ret = Operation_Success;
+        }
+        
+        /* The sync signal for the next frame is sent in the next call, USB is busy now */
+        return ret;
+    }
+    
+    /* Ask for the ack signal, and ask again if it is lost */
+    if((SyncSignalPending == (bool)FALSE) || ((HAL_GetTick() - SyncSignalTick) >= ACK_SIGNAL_TIMEOUT))
+    {
+        if(SendSyncSignalToPC() == Operation_Success)
+        {
+            SyncSignalPending = (bool)TRUE;
+            SyncSignalTick    = HAL_GetTick();
+        }
+    }
+    
+    return ret;
+}
+
+/** 
+* @description                : Send the frames of the ADC sample ring to PC in batches, called in the main loop
+*                               Up to ADC_BATCH_FRAME_NUM frames go in one CDC transfer (see the batched frame format),
+*                               a partial batch is sent once its oldest frame has waited ADC_BATCH_TIMEOUT.
+*                               Both can be lowered by the upper computer with COMMAND_SET_BATCH.
+*                               Once the upper computer grants credit (CREDIT_SIGNAL) the batches are sent back to back
+*                               while credit is left, the rate is then bounded by the USB bandwidth and not by the 
+*                               round trip of the handshake. Until then every batch keeps the sync/ack handshake
+* @param   {void}    
+* @return  {t_FuncRet}        : Operation_Success if a batch was sent, Operation_Wait if nothing was sent
+* @author: leeqingshui 
+*/
+t_FuncRet SendADCBatchToPC(void)
+{
+    t_FuncRet ret = Operation_Wait;
+    
+    uint32_t Count, Overrun, High_Water;
+    uint32_t Credit    = StreamCreditGranted - StreamCreditUsed;
+    uint16_t Max_Frame = ADC_Batch_FrameMax;
+    Sample_Frame Frame;
+    
+    /* The stream is switched off: drop the frames so that it starts again with fresh ones */
+    if((StreamSelect & STREAM_SELECT_ADC) == 0)
+    {
+        while(Get_ADC_Frame(&Frame) == Operation_Success)
+        {
+        }
+        ADC_Batch_Len       = 0;
+        ADC_Batch_WaitValid = (bool)FALSE;
+        ADC_Batch_NextValid = (bool)FALSE;
+        return ret;
+    }
+    
+    /* Keep one batch at hand, it is only dropped after it has been sent */
+    if(ADC_Batch_Len == 0)
+    {
+        /* A batch never holds more frames than the credit left */
+        if(StreamCreditMode != (bool)FALSE)
+        {
+            if(Credit == 0)
+            {
+                return ret;
+            }
+            if(Credit < Max_Frame)
+            {
+                Max_Frame = (uint16_t)Credit;
+            }
+        }
+        
+        Get_ADC_SampleRing_State(&Count, &Overrun, &High_Water);
+        if(ADC_Batch_NextValid != (bool)FALSE)
+        {
+            Count++;
+        }
+        
+        if(Count == 0)
+        {
+            ADC_Batch_WaitValid = (bool)FALSE;
+            return ret;
+        }
+        if(Count < Max_Frame)
+        {
+            if(ADC_Batch_WaitValid == (bool)FALSE)
+            {
+                ADC_Batch_WaitTick  = HAL_GetTick();
+                ADC_Batch_WaitValid = (bool)TRUE;
+            }
+            if((HAL_GetTick() - ADC_Batch_WaitTick) < ADC_Batch_Timeout)
+            {
+                return ret;
+            }
+        }
+        
+        ADC_Batch_Len       = ADC_Batch_Build(ADC_Batch_Buf, Max_Frame, StreamEncoding, &ADC_Batch_FrameNum);
+        ADC_Batch_WaitValid = (bool)FALSE;
+        if(ADC_Batch_Len == 0)
+        {
+            return ret;
+        }
+    }
+    
+    /* Credit based flow control: send as long as the batch is covered by the credit left */
+    if(StreamCreditMode != (bool)FALSE)
+    {
+        if((Credit >= ADC_Batch_FrameNum) && (DataWrite(ADC_Batch_Buf, ADC_Batch_Len) == USBD_OK))
+        {
+            StreamCreditUsed = StreamCreditUsed + ADC_Batch_FrameNum;
+            ADC_Batch_Len    = 0;
+            ret = Operation_Success;
+        }
+        
+        return ret;
+    }
+    
+    /* The upper computer acknowledged the last sync signal: send the batch */
+    if(AckSignalRecvFlag != (bool)FALSE)
+    {
+        if(DataWrite(ADC_Batch_Buf, ADC_Batch_Len) == USBD_OK)
+        {
+            AckSignalRecvFlag = (bool)FALSE;
+            SyncSignalPending = (bool)FALSE;
+            ADC_Batch_Len     = 0;
+            ret = Operation_Success;
+        }
+        
+        return ret;
+    }
+    
+    /* Ask for the ack signal, and ask again if it is lost */
+    if((SyncSignalPending == (bool)FALSE) || ((HAL_GetTick() - SyncSignalTick) >= ACK_SIGNAL_TIMEOUT))
+    {
+        if(SendSyncSignalToPC() == Operation_Success)
+        {
+            SyncSignalPending = (bool)TRUE;
+            SyncSignalTick    = HAL_GetTick();
+        }
+    }
+    
+    return ret;
+}
+
+/** 
+* @description                : CRC16-CCITT of a byte buffer (polynomial 0x1021, no reflection), one nibble per table lookup
+* @param   {uint8_t*} p_Data  : Data
+* @param   {uint32_t} Len     : Number of bytes
+* @param   {uint16_t} Crc     : 0xFFFF for a new CRC, or the CRC of the previous part of the data
+* @return  {uint16_t}         : CRC of the data
+* @author: leeqingshui 
+*/
+uint16_t CRC16_CCITT(const uint8_t* p_Data, uint32_t Len, uint16_t Crc)
+{
+    for(uint32_t i = 0; i < Len; i++)
+    {
+        Crc = (uint16_t)(Crc << 4) ^ CRC16_CCITT_Table[(Crc >> 12) ^ (p_Data[i] >> 4)];
+        Crc = (uint16_t)(Crc << 4) ^ CRC16_CCITT_Table[(Crc >> 12) ^ (p_Data[i] & 0x0F)];
+    }
+    
+    return Crc;
+}
+
+/** 
+* @description                : Send the latest motion data of the gyroscope to PC, called in the main loop
+*                               Data0/Data1 - X/Y axis angle, Data2/Data3 - X/Y axis Angle_Acc,
+*                               the timestamp is the one of the angel packet, so that the upper computer 
+*                               can align it with the ADC frames
+* @param   {void}    
+* @return  {t_FuncRet}        : Operation_Success if the data was sent, Operation_Wait if no new data
+* @author: leeqingshui 
+*/
+t_FuncRet SendMotionDataToPC(void)
+{
+    t_FuncRet ret = Operation_Success;
+    
+    float32_t angle_x, angle_y, gyro_x, gyro_y;
+    uint32_t  Timestamp;
+    
+    if((StreamSelect & STREAM_SELECT_MOTION) == 0)
+    {
+        return ret = Operation_Wait;
+    }
+    
+    ret = Get_MotionData_Latest(&angle_x, &angle_y, &gyro_x, &gyro_y, &Timestamp);
+    if(ret != Operation_Success)
+    {
+        return ret;
+    }
+    
+    return SendDataToPC(GYROSCOPE_TYPE, (void*)&angle_x, (void*)&angle_y, (void*)&gyro_x, (void*)&gyro_y, Timestamp);
+}
+
+/** 
+* @description                : Send the spectral features of the EMG channels to PC, called in the main loop
+*                               Every channel with a new window sends a SPECTRUM_TYPE frame followed by a
+*                               SPECTRUM_BAND_TYPE frame, both with the time of the last sample of the window
+* @param   {void}    
+* @return  {t_FuncRet}        : Operation_Success if features were sent, Operation_Wait if no new window
+* @author: leeqingshui 
+*/
+t_FuncRet SendSpectrumToPC(void)
+{
+    t_FuncRet ret = Operation_Wait;
+    
+    Spectrum_Features Features;
+    uint32_t          Timestamp;
+    uint16_t          Data[ADC_EMG_SPECTRUM_BAND_NUM];
+    uint16_t          Channel, Mean_Freq, Median_Freq, Rms;
+    
+    if((StreamSelect & STREAM_SELECT_SPECTRUM) == 0)
+    {
+        return ret;
+    }
+    
+    for(uint8_t ch = 0; ch < ADC_EMG_CHANNEL_NUM; ch++)
+    {
+        if(Get_ADC_EMG_Spectrum_Features((ADC_Channel_ID)ch, &Features, &Timestamp) != Operation_Success)
+        {
+            continue;
+        }
+        
+        Channel     = ch;
+        Mean_Freq   = (uint16_t)(Features.Mean_Freq*10 + 0.5f);
+        Median_Freq = (uint16_t)(Features.Median_Freq*10 + 0.5f);
+        Rms         = (uint16_t)(sqrtf(Features.Total_Power) + 0.5f);
+        
+        for(uint8_t b = 0; b < ADC_EMG_SPECTRUM_BAND_NUM; b++)
+        {
+            Data[b] = (Features.Total_Power > 0) ? (uint16_t)(Features.Band_Power[b]/Features.Total_Power*10000 + 0.5f) : 0;
+        }
+        
+        if((SendDataToPC(SPECTRUM_TYPE, (void*)&Channel, (void*)&Mean_Freq, (void*)&Median_Freq, (void*)&Rms, 
+                         Timestamp) != Operation_Success) ||
+           (SendDataToPC(SPECTRUM_BAND_TYPE, (void*)&Data[0], (void*)&Data[1], (void*)&Data[2], (void*)&Data[3], 
+                         Timestamp) != Operation_Success))
+        {
+            return ret = Operation_Fail;
+        }
+        
+        ret = Operation_Success;
+    }
+    
+    return ret;
+}
+
+/** 
+* @description                : Build one batch from the frames of the ADC sample ring.
+*                               The batch ends at the first frame that does not follow the previous one (frames dropped
+*                               by a full ring), that frame is kept to start the next batch
+* @param   {uint8_t*}  p_Buf         : Batch buffer, ADC_BATCH_BUF_SIZE bytes
+* @param   {uint16_t}  Max_Frame_Num : Largest number of frames, 1 - ADC_BATCH_FRAME_NUM
+* @param   {uint8_t}   Encoding      : STREAM_ENCODING_RAW or STREAM_ENCODING_DELTA
+* @param   {uint16_t*} p_Frame_Num   : Number of frames in the batch
+* @return  {uint16_t}                : Bytes of the batch, 0 if the ring is empty
+* @author: leeqingshui 
+*/
+static uint16_t ADC_Batch_Build(uint8_t* p_Buf, uint16_t Max_Frame_Num, uint8_t Encoding, uint16_t* p_Frame_Num)
+{
+    Sample_Frame Frame;
+    uint8_t*     p_Data    = &p_Buf[ADC_BATCH_HEAD_SIZE];
+    uint16_t     Frame_Num = 0;
+    uint16_t     Crc;
+    
+    uint16_t Value[ADC_BATCH_CHANNEL_NUM];
+    uint16_t Last[ADC_BATCH_CHANNEL_NUM];
+    uint16_t Zigzag;
+    uint32_t Last_Index = 0;
+    
+    while(Frame_Num < Max_Frame_Num)
+    {
+        /* A frame is only taken out of the ring if it fits in the buffer even with the longest deltas */
+        if((Encoding == STREAM_ENCODING_DELTA) && 
+           ((p_Data - p_Buf) + ADC_BATCH_DELTA_FRAME_MAX + ADC_BATCH_TAIL_SIZE > ADC_BATCH_BUF_SIZE))
+        {
+            break;
+        }
+        if(ADC_Batch_NextValid != (bool)FALSE)
+        {
+            Frame               = ADC_Batch_NextFrame;
+            ADC_Batch_NextValid = (bool)FALSE;
+        }
+        else if(Get_ADC_Frame(&Frame) != Operation_Success)
+        {
+            break;
+        }
+        
+        /* The header only describes consecutive frames, and a delta never spans the gap */
+        if((Frame_Num != 0) && (Frame.SampleIndex != Last_Index + 1))
+        {
+            ADC_Batch_NextFrame = Frame;
+            ADC_Batch_NextValid = (bool)TRUE;
+            break;
+        }
+        Last_Index = Frame.SampleIndex;
+        
+        /* The header takes the index and the time of the first frame */
+        if(Frame_Num == 0)
+        {
+            p_Buf[3]  = (uint8_t)(Frame.SampleIndex >> 24);
+            p_Buf[4]  = (uint8_t)(Frame.SampleIndex >> 16);
+            p_Buf[5]  = (uint8_t)(Frame.SampleIndex >> 8);
+            p_Buf[6]  = (uint8_t)(Frame.SampleIndex);
+            p_Buf[7]  = (uint8_t)(Frame.Timestamp >> 24);
+            p_Buf[8]  = (uint8_t)(Frame.Timestamp >> 16);
+            p_Buf[9]  = (uint8_t)(Frame.Timestamp >> 8);
+            p_Buf[10] = (uint8_t)(Frame.Timestamp);
+        }
+        
+        for(uint8_t ch = 0; ch < SAMPLE_FRAME_CHANNEL_NUM; ch++)
+        {
+            Value[ch] = Frame.Data[ch];
+        }
+        Value[SAMPLE_FRAME_CHANNEL_NUM] = Frame.Vref;
+        
+        for(uint8_t ch = 0; ch < ADC_BATCH_CHANNEL_NUM; ch++)
+        {
+            /* Raw data, or the keyframe of a delta encoded batch */
+            if((Encoding != STREAM_ENCODING_DELTA) || (Frame_Num == 0))
+            {
+                *p_Data++ = GET_HIGH_BYTE(Value[ch]);
+                *p_Data++ = GET_LOW_BYTE(Value[ch]);
+            }
+            else
+            {
+                /* Zig-zag of the 16 bit delta: the sign goes to bit 0 so that small deltas of both signs stay small */
+                Zigzag = (uint16_t)(Value[ch] - Last[ch]);
+                Zigzag = (uint16_t)((Zigzag << 1) ^ ((Zigzag & 0x8000U) ? 0xFFFFU : 0x0000U));
+                
+                while(Zigzag >= 0x80U)
+                {
+                    *p_Data++ = (uint8_t)(Zigzag | 0x80U);
+                    Zigzag    = Zigzag >> 7;
+                }
+                *p_Data++ = (uint8_t)Zigzag;
+            }
+            Last[ch] = Value[ch];
+        }
+        
+        Frame_Num++;
+    }
+    
+    *p_Frame_Num = Frame_Num;
+    if(Frame_Num == 0)
+    {
+        return 0;
+    }
+    
+    p_Buf[0]  = (uint8_t)FRAME_HEADER;
+    p_Buf[1]  = (uint8_t)FRAME_HEADER;
+    p_Buf[2]  = (Encoding == STREAM_ENCODING_DELTA) ? (uint8_t)ADC_BATCH_DELTA_TYPE : (uint8_t)ADC_BATCH_TYPE;
+    p_Buf[11] = (uint8_t)Frame_Num;
+    p_Buf[12] = (uint8_t)ADC_BATCH_CHANNEL_NUM;
+    
+    Crc       = CRC16_CCITT(p_Buf, (uint32_t)(p_Data - p_Buf), 0xFFFF);
+    *p_Data++ = GET_HIGH_BYTE(Crc);
+    *p_Data++ = GET_LOW_BYTE(Crc);
+    *p_Data++ = (uint8_t)FRAME_STOP;
+    
+    return (uint16_t)(p_Data - p_Buf);
+}
+
+/** 
+* @description                : Feed one received byte to the command frame parser, called in the USB interrupt.
+*                               A frame with a bad length or CRC is dropped and the parser looks for the next header
+* @param   {uint8_t} Data     : Received byte
+* @return  {void}
+* @author: leeqingshui 
+*/
+static void Command_Parse_Byte(uint8_t Data)
+{
+    uint8_t Next;
+    
+    switch(Command_Parse_State)
+    {
+        case COMMAND_PARSE_HEADER1:
+            if(Data == COMMAND_HEADER1)
+            {
+                Command_Parse_State = COMMAND_PARSE_HEADER2;
+            }
+            break;
+            
+        case COMMAND_PARSE_HEADER2:
+            /* A repeated first header byte may be the real start of the frame */
+            if(Data == COMMAND_HEADER2)
+            {
+                Command_Parse_State = COMMAND_PARSE_CMD;
+            }
+            else if(Data != COMMAND_HEADER1)
+            {
+                Command_Parse_State = COMMAND_PARSE_HEADER1;
+            }
+            break;
+            
+        case COMMAND_PARSE_CMD:
+            Command_Parse_Frame.Cmd = Data;
+            Command_Parse_Crc       = CRC16_CCITT(&Data, 1, 0xFFFF);
+            Command_Parse_State     = COMMAND_PARSE_LEN;
+            break;
+            
+        case COMMAND_PARSE_LEN:
+            if(Data > COMMAND_PAYLOAD_MAX)
+            {
+                Command_Error_Count++;
+                Command_Parse_State = COMMAND_PARSE_HEADER1;
+                break;
+            }
+            Command_Parse_Frame.Len = Data;
+            Command_Parse_Crc       = CRC16_CCITT(&Data, 1, Command_Parse_Crc);
+            Command_Parse_Index     = 0;
+            Command_Parse_State     = (Data == 0) ? COMMAND_PARSE_CRC_H : COMMAND_PARSE_PAYLOAD;
+            break;
+            
+        case COMMAND_PARSE_PAYLOAD:
+            Command_Parse_Frame.Payload[Command_Parse_Index++] = Data;
+            Command_Parse_Crc = CRC16_CCITT(&Data, 1, Command_Parse_Crc);
+            if(Command_Parse_Index >= Command_Parse_Frame.Len)
+            {
+                Command_Parse_State = COMMAND_PARSE_CRC_H;
+            }
+            break;
+            
+        case COMMAND_PARSE_CRC_H:
+            if(Data != GET_HIGH_BYTE(Command_Parse_Crc))
+            {
+                Command_Error_Count++;
+                Command_Parse_State = COMMAND_PARSE_HEADER1;
+                break;
+            }
+            Command_Parse_State = COMMAND_PARSE_CRC_L;
+            break;
+            
+        case COMMAND_PARSE_CRC_L:
+            Command_Parse_State = COMMAND_PARSE_HEADER1;
+            if(Data != GET_LOW_BYTE(Command_Parse_Crc))
+            {
+                Command_Error_Count++;
+                break;
+            }
+            
+            Next = (uint8_t)((Command_Queue_Tail + 1) % (COMMAND_QUEUE_NUM + 1));
+            if(Next == Command_Queue_Head)
+            {
+                Command_Error_Count++;
+                break;
+            }
+            Command_Queue[Command_Queue_Tail] = Command_Parse_Frame;
+            Command_Queue_Tail = Next;
+            Command_Recv_Count++;
+            break;
+            
+        default:
+            Command_Parse_State = COMMAND_PARSE_HEADER1;
+            break;
+    }
+}
+
+/** 
+* @description                     : Execute one command and fill in the payload of its reply
+* @param   {const Command_Frame*} p_Cmd       : Command received from the upper computer
+* @param   {uint8_t*}             p_Reply     : Payload of the reply, COMMAND_PAYLOAD_MAX bytes
+* @param   {uint8_t*}             p_Reply_Len : Number of bytes of the reply payload
+* @return  {uint8_t}                          : COMMAND_STATUS_xxx
+* @author: leeqingshui 
+*/
+static uint8_t Command_Execute(const Command_Frame* p_Cmd, uint8_t* p_Reply, uint8_t* p_Reply_Len)
+{
+    uint8_t  Status = COMMAND_STATUS_OK;
+    
+    uint32_t Stats[COMMAND_STATS_NUM];
+    uint16_t Position, Time;
+    
+    *p_Reply_Len = 0;
+    
+    switch(p_Cmd->Cmd)
+    {
+        case COMMAND_SET_SAMPLE_PROFILE:
+            /* The profile is switched by ADC_SampleProfile_Process, which also reports the achieved rate */
+            if((p_Cmd->Len != 1) || (ADC_Request_SampleProfile(p_Cmd->Payload[0]) != Operation_Success))
+            {
+                Status = COMMAND_STATUS_INVALID;
+            }
+            break;
+            
+        case COMMAND_SELECT_STREAMS:
+            if((p_Cmd->Len != 1) || ((p_Cmd->Payload[0] & ~STREAM_SELECT_ALL) != 0))
+            {
+                Status = COMMAND_STATUS_INVALID;
+                break;
+            }
+            StreamSelect = p_Cmd->Payload[0];
+            break;
+            
+        case COMMAND_SET_BATCH:
+            if((p_Cmd->Len != 2) || (p_Cmd->Payload[0] < 1) || (p_Cmd->Payload[0] > ADC_BATCH_FRAME_NUM) || 
+               (p_Cmd->Payload[1] < 1))
+            {
+                Status = COMMAND_STATUS_INVALID;
+                break;
+            }
+            ADC_Batch_FrameMax = p_Cmd->Payload[0];
+            ADC_Batch_Timeout  = p_Cmd->Payload[1];
+            break;
+            
+        case COMMAND_SET_ENCODING:
+            if((p_Cmd->Len != 1) || 
+               ((p_Cmd->Payload[0] != STREAM_ENCODING_RAW) && (p_Cmd->Payload[0] != STREAM_ENCODING_DELTA)))
+            {
+                Status = COMMAND_STATUS_INVALID;
+                break;
+            }
+            StreamEncoding = p_Cmd->Payload[0];
+            break;
+            
+        case COMMAND_READ_STATS:
+            Get_ADC_SampleRing_State(&Stats[0], &Stats[1], &Stats[2]);
+            CDC_Get_TxQueue_State(&Stats[3], &Stats[4], &Stats[5]);
+            Stats[6] = (StreamCreditMode != (bool)FALSE) ? (StreamCreditGranted - StreamCreditUsed) : 0;
+            Stats[7] = Command_Recv_Count;
+            Stats[8] = Command_Error_Count;
+            
+            for(uint8_t i = 0; i < COMMAND_STATS_NUM; i++)
+            {
+                *p_Reply++ = (uint8_t)(Stats[i] >> 24);
+                *p_Reply++ = (uint8_t)(Stats[i] >> 16);
+                *p_Reply++ = (uint8_t)(Stats[i] >> 8);
+                *p_Reply++ = (uint8_t)(Stats[i]);
+            }
+            *p_Reply_Len = 4*COMMAND_STATS_NUM;
+            break;
+            
+        case COMMAND_MOVE_SERVO:
+            if(p_Cmd->Len != 5)
+            {
+                Status = COMMAND_STATUS_INVALID;
+                break;
+            }
+            Position = BYTE_TO_HW(p_Cmd->Payload[1], p_Cmd->Payload[2]);
+            Time     = BYTE_TO_HW(p_Cmd->Payload[3], p_Cmd->Payload[4]);
+            if((p_Cmd->Payload[0] > 253) || (Position > 1000) || (Time > 30000) || 
+               (ServoMotor_Move_Immediately(p_Cmd->Payload[0], (int16_t)Position, Time) != Operation_Success))
+            {
+                Status = COMMAND_STATUS_INVALID;
+            }
+            break;
+            
+        case COMMAND_SET_OVERSAMPLING:
+            if((p_Cmd->Len != 3) || (p_Cmd->Payload[0] >= ADC_EMG_CHANNEL_NUM) || 
+               (Set_ADC_Oversampling((ADC_Channel_ID)p_Cmd->Payload[0], BYTE_TO_HW(p_Cmd->Payload[1], p_Cmd->Payload[2])) != Operation_Success))
+            {
+                Status = COMMAND_STATUS_INVALID;
+            }
+            break;
+            
+        default:
+            Status = COMMAND_STATUS_UNKNOWN;
+            break;
+    }
+    
+    return Status;
+}
 
+/** 
+* @description                     : Send a reply frame to PC
+* @param   {uint8_t}        Cmd       : Command code of the command answered
+* @param   {uint8_t}        Status    : COMMAND_STATUS_xxx
+* @param   {const uint8_t*} p_Payload : Payload of the reply
+* @param   {uint8_t}        Len       : Number of bytes of the payload, COMMAND_PAYLOAD_MAX at most
+* @return  {t_FuncRet}                : Operation_Success if the reply was queued
+* @author: leeqingshui 
+*/
+static t_FuncRet SendCommandReplyToPC(uint8_t Cmd, uint8_t Status, const uint8_t* p_Payload, uint8_t Len)
+{
+    t_FuncRet ret = Operation_Success;
+    
+    uint8_t  Buf[COMMAND_REPLY_HEAD_SIZE + COMMAND_PAYLOAD_MAX + COMMAND_REPLY_TAIL_SIZE];
+    uint8_t* p_Data = &Buf[COMMAND_REPLY_HEAD_SIZE];
+    uint16_t Crc;
+    
+    Buf[0] = (uint8_t)FRAME_HEADER;
+    Buf[1] = (uint8_t)FRAME_HEADER;
+    Buf[2] = (uint8_t)COMMAND_REPLY_TYPE;
+    Buf[3] = Cmd;
+    Buf[4] = Status;
+    Buf[5] = Len;
+    
+    for(uint8_t i = 0; i < Len; i++)
+    {
+        *p_Data++ = p_Payload[i];
+    }
+    
+    Crc       = CRC16_CCITT(Buf, (uint32_t)(p_Data - Buf), 0xFFFF);
+    *p_Data++ = GET_HIGH_BYTE(Crc);
+    *p_Data++ = GET_LOW_BYTE(Crc);
+    *p_Data++ = (uint8_t)FRAME_STOP;
+    
+    /* The transmit queue copies the reply, so it can be built on the stack */
+    if(DataWrite(Buf, (uint16_t)(p_Data - Buf)) != USBD_OK)
+    {
+        ret = Operation_Fail;
+    }
+    
+    return ret;
+}
@@ -27,6 +27,19 @@
 /* Data type macro definition */
 #define ADC_TYPE                            0
 #define GYROSCOPE_TYPE                      1
+#define SAMPLE_PROFILE_TYPE                 2
+/* 
+    Spectral features of one EMG channel, sent instead of the raw samples of a whole window:
+    SPECTRUM_TYPE      - Data0: channel 0 - 3, Data1/Data2: mean/median frequency (unit: 0.1Hz), Data3: rms of the window (unit: mV)
+    SPECTRUM_BAND_TYPE - Data0 ~ Data3: power of the 4 bands in 1/10000 of the total power,
+                         it follows the SPECTRUM_TYPE frame of the same channel with the same timestamp
+*/
+#define SPECTRUM_TYPE                       3
+#define SPECTRUM_BAND_TYPE                  4
+/* A batch of ADC frames in one transfer, see the batched frame format below */
+#define ADC_BATCH_TYPE                      5
+#define ADC_BATCH_DELTA_TYPE                6
+#define COMMAND_REPLY_TYPE                  7
 
 /* Format frame macro definition */
 #define FRAME_HEADER                        0x55
@@ -36,6 +49,117 @@
 #define SYNC_SIGNAL                         0x56
 #define ACK_SIGNAL                          0x57
 
+/* 
+    Macro definition of the sampling profile switch signal
+    | 0x58 | Profile number | , Profile number : 0 - 2000Hz, 1 - 4000Hz, 2 - 8000Hz, 3 - 10000Hz, 4 - 20000Hz (Vref injected only)
+    The device answers with a SAMPLE_PROFILE_TYPE frame after the switch
+*/
+#define SAMPLE_PROFILE_SIGNAL               0x58
+
+/* 
+    Macro definition of the credit signal (credit based flow control of the batched ADC stream)
+    | 0x59 | CREDIT_H | CREDIT_L | , the upper computer grants CREDIT more frames (1 - 65535)
+    After the first credit signal the batches are streamed without the sync/ack handshake as long as credit is left,
+    every batch uses as many credits as it has frames. Before it every batch waits for the sync/ack handshake
+*/
+#define CREDIT_SIGNAL                       0x59
+
+/* 
+    Macro definition of the stream encoding signal
+    | 0x5B | Encoding | , Encoding : STREAM_ENCODING_RAW or STREAM_ENCODING_DELTA
+    The encoding is applied from the next batch on, the type byte of every batch tells how it is encoded.
+    Single byte signals never take the value of a command header byte
+*/
+#define STREAM_ENCODING_SIGNAL              0x5B
+#define STREAM_ENCODING_RAW                 0
+#define STREAM_ENCODING_DELTA               1
+
+/* 
+    Command frame sent by the upper computer (big endian), it may be split across USB packets 
+    and one packet may hold several of them:
+    | 0xA5 | 0x5A | CMD | LEN | PAYLOAD (LEN bytes) | CRC_H | CRC_L |
+    CRC : CRC16-CCITT (0x1021, initial value 0xFFFF) of CMD, LEN and PAYLOAD
+    A packet that does not start with COMMAND_HEADER1 while no command frame is open is taken as a single byte signal.
+    A frame whose next packet does not arrive within COMMAND_PARSE_TIMEOUT is dropped
+    
+    Every command is answered with a reply frame:
+    | 0x55 | 0x55 | COMMAND_REPLY_TYPE | CMD | STATUS | LEN | PAYLOAD (LEN bytes) | CRC_H | CRC_L | Stop |
+    CRC : CRC16-CCITT (0x1021, initial value 0xFFFF) of every byte from the first header byte to the last payload byte
+*/
+#define COMMAND_HEADER1                     0xA5
+#define COMMAND_HEADER2                     0x5A
+/* Largest payload of a command frame and of a reply frame */
+#define COMMAND_PAYLOAD_MAX                 40
+/* Number of received commands waiting for the main loop */
+#define COMMAND_QUEUE_NUM                   4
+/* Longest gap between two packets of one command frame, unit: ms */
+#define COMMAND_PARSE_TIMEOUT               50
+
+/* Command codes and their payload */
+/* | Profile number | , see SAMPLE_PROFILE_SIGNAL */
+#define COMMAND_SET_SAMPLE_PROFILE          0x01
+/* | Stream mask | , STREAM_SELECT_xxx bits */
+#define COMMAND_SELECT_STREAMS              0x02
+/* | Frame_Num | Timeout | , frames per batch 1 - ADC_BATCH_FRAME_NUM and longest wait for a full batch 1 - 255 ms */
+#define COMMAND_SET_BATCH                   0x03
+/* | Encoding | , see STREAM_ENCODING_SIGNAL */
+#define COMMAND_SET_ENCODING                0x04
+/* 
+    No payload, the reply holds COMMAND_STATS_NUM values of 4 bytes:
+    frames in the ADC sample ring, frames lost by the ring, most frames in the ring,
+    slots in the CDC transmit queue, writes refused by the queue, most slots in the queue,
+    credit left, commands received, command frames rejected (CRC, length, timeout or full queue)
+*/
+#define COMMAND_READ_STATS                  0x05
+#define COMMAND_STATS_NUM                   9
+/* | ID | POSITION_H | POSITION_L | TIME_H | TIME_L | , position 0 - 1000 (0 - 240 degree), time 0 - 30000 ms */
+#define COMMAND_MOVE_SERVO                  0x06
+/* | Channel | RATIO_H | RATIO_L | , channel 0 - 3 (sensor 1 - 4), ratio a power of 2 in 1 - 256, 1 turns oversampling off */
+#define COMMAND_SET_OVERSAMPLING            0x07
+
+/* Status of a reply frame */
+#define COMMAND_STATUS_OK                   0
+#define COMMAND_STATUS_INVALID              1
+#define COMMAND_STATUS_UNKNOWN              2
+
+/* Streams sent by the main loop, all of them after power on */
+#define STREAM_SELECT_ADC                   0x01
+#define STREAM_SELECT_MOTION                0x02
+#define STREAM_SELECT_SPECTRUM              0x04
+#define STREAM_SELECT_ALL                   (STREAM_SELECT_ADC | STREAM_SELECT_MOTION | STREAM_SELECT_SPECTRUM)
+
+/* 
+    Batched ADC frame format (big endian), one CDC transfer:
+    | 0x55 | 0x55 | ADC_BATCH_TYPE | SEQUENCE3 ~ 0 | TIMESTAMP3 ~ 0 | Frame_Num | Channel_Num |
+    | Frame_Num x Channel_Num x (DATA_H | DATA_L) | CRC_H | CRC_L | Stop |
+    SEQUENCE  : sample index of the first frame, continuous across batches unless frames were dropped.
+                The frames of one batch are always consecutive, a batch ends before a gap in the sample index
+    TIMESTAMP : acquisition time of the first frame, unit: us
+    DATA      : voltage, unit: mV, the channels of one frame are sensor 1 - 4 then Vref
+    CRC       : CRC16-CCITT (0x1021, initial value 0xFFFF) of every byte from the first header byte to the last data byte
+    
+    Delta encoded batch (ADC_BATCH_DELTA_TYPE, STREAM_ENCODING_DELTA), same header and tail:
+    | Channel_Num x (DATA_H | DATA_L) | (Frame_Num - 1) x Channel_Num x DELTA |
+    The first frame is a keyframe sent as is, so every batch is decoded on its own and a lost batch costs no resync.
+    DELTA : difference to the same channel of the previous frame, modulo 65536 as a signed 16 bit value,
+            zig-zag mapped (0, -1, 1, -2 ... to 0, 1, 2, 3 ...) and sent as a varint: 7 bits per byte, 
+            lowest bits first, bit 7 set if more bytes follow (1 - 3 bytes)
+    A delta encoded batch never exceeds the size of a raw batch of ADC_BATCH_FRAME_NUM frames, so it may hold fewer frames
+*/
+/* Number of frames sent in one batch, a partial batch is sent after ADC_BATCH_TIMEOUT */
+#define ADC_BATCH_FRAME_NUM                 40
+/* Longest time the oldest frame waits for a full batch, unit: ms */
+#define ADC_BATCH_TIMEOUT                   20
+/* Number of channels of one frame in a batch: sensor 1 - 4 and Vref */
+#define ADC_BATCH_CHANNEL_NUM               5
+/* Bytes of the batch before the data and after the data */
+#define ADC_BATCH_HEAD_SIZE                 13
+#define ADC_BATCH_TAIL_SIZE                 3
+/* Bytes of a batch of Frame_Num frames */
+#define ADC_BATCH_SIZE(Frame_Num)           (ADC_BATCH_HEAD_SIZE + 2*ADC_BATCH_CHANNEL_NUM*(Frame_Num) + ADC_BATCH_TAIL_SIZE)
+/* Most bytes of one delta encoded frame */
+#define ADC_BATCH_DELTA_FRAME_MAX           (3*ADC_BATCH_CHANNEL_NUM)
+
 /* The macro gets the lower octet of A */
 #define GET_LOW_BYTE(DATA) 					((uint8_t)(DATA))
 /* The macro gets the higher eight digits of A */
@@ -43,15 +167,16 @@
 /* The macro function synthesizes the high eight bits into 16 bits */
 #define BYTE_TO_HW(DATA_A , DATA_B) 		((((uint16_t)(DATA_A)) << 8) | (uint8_t)(DATA_B))
 /* Macro function to determine whether the data type is correct */
-#define IS_TRUE_DATATYPE(PERIPH)            ((PERIPH == ADC_TYPE)||(PERIPH == GYROSCOPE_TYPE))
+#define IS_TRUE_DATATYPE(PERIPH)            ((PERIPH == ADC_TYPE)||(PERIPH == GYROSCOPE_TYPE)||(PERIPH == SAMPLE_PROFILE_TYPE)|| \
+                                             (PERIPH == SPECTRUM_TYPE)||(PERIPH == SPECTRUM_BAND_TYPE))
 
 /* Data structure declaration-------------------------------------------------*/
 
 /* 
     The upper computer sends data structures
     Communication protocol format
-    | frame header | | frame header | DataType | DATAx_H | DATAx_L | Stop |
-    x = 0~3
+    | frame header | | frame header | DataType | DATAx_H | DATAx_L | TIMESTAMPy | Stop |
+    x = 0~3, y = 3~0 (TIMESTAMP3 is the highest byte)
 */
 typedef struct
 {
@@ -85,6 +210,16 @@ typedef struct
     uint8_t Data3_H;
     uint8_t Data3_L;
     
+    /*
+        TIMESTAMPy
+        Free-running 32 bits acquisition time of the data (unit: us), it wraps every 71.6 minutes.
+        The upper computer uses it to align the ADC and the gyroscope streams
+    */
+    uint8_t Timestamp3;
+    uint8_t Timestamp2;
+    uint8_t Timestamp1;
+    uint8_t Timestamp0;
+    
     /*
         Stop
         Sending 0x78 indicates the end of sending a data frame
@@ -92,12 +227,24 @@ typedef struct
     uint8_t Stop;
 }SendDataToPCFrame;
 
+/* One command frame received from the upper computer */
+typedef struct
+{
+    /* Command code */
+    uint8_t Cmd;
+    /* Number of payload bytes */
+    uint8_t Len;
+    uint8_t Payload[COMMAND_PAYLOAD_MAX];
+}Command_Frame;
+
 /* Extern Variable------------------------------------------------------------*/
 
 /* Synchronization signal received flag bit */
-extern bool AckSignalRecvFlag;
+extern volatile bool AckSignalRecvFlag;
+/* Number of frames granted by the credit signals since power on, written in the USB interrupt */
+extern volatile uint32_t StreamCreditGranted;
 /* USB virtual serial port receiving flag bit */
-extern bool USBRecvSuccessFlag;
+extern volatile bool USBRecvSuccessFlag;
 
 /* Function declaration-------------------------------------------------------*/
 
@@ -106,7 +253,29 @@ t_FuncRet SendSyncSignalToPC(void);
 /* Ack signal reception confirmation function */
 t_FuncRet AckSignal_Recv(uint8_t* Buf);
 /* A function that sends data to PC */
-t_FuncRet SendDataToPC(uint8_t DataType, void* Data0, void* Data1, void* Data2, void* Data3);
+t_FuncRet SendDataToPC(uint8_t DataType, void* Data0, void* Data1, void* Data2, void* Data3, uint32_t Timestamp);
+/* Sampling profile switch signal reception function */
+t_FuncRet SampleProfile_Recv(uint8_t* Buf, uint32_t Len);
+/* Credit signal reception function */
+t_FuncRet Credit_Recv(uint8_t* Buf, uint32_t Len);
+/* Stream encoding signal reception function */
+t_FuncRet StreamEncoding_Recv(uint8_t* Buf, uint32_t Len);
+/* Command frame reception function */
+t_FuncRet Command_Recv(uint8_t* Buf, uint32_t Len);
+/* Execute the received commands and answer them, called in the main loop */
+t_FuncRet Command_Process(void);
+/* Report the current sampling profile and the achieved sampling rate to PC */
+t_FuncRet SendSampleProfileToPC(void);
+/* Send the frames of the ADC sample ring to PC, called in the main loop */
+t_FuncRet SendADCStreamToPC(void);
+/* Send the frames of the ADC sample ring to PC in batches within the granted credit, called in the main loop */
+t_FuncRet SendADCBatchToPC(void);
+/* CRC16-CCITT of a byte buffer */
+uint16_t CRC16_CCITT(const uint8_t* p_Data, uint32_t Len, uint16_t Crc);
+/* Send the latest motion data of the gyroscope to PC, called in the main loop */
+t_FuncRet SendMotionDataToPC(void);
+/* Send the spectral features of the EMG channels to PC, called in the main loop */
+t_FuncRet SendSpectrumToPC(void);
 
 
 #ifdef __cplusplus
@@ -5,10 +5,19 @@
   * Description        : This file contains basic operations on the ADC, including 
   *						 initialization, reading data, returning data, and so on
   *
+  *						 ADC_MODE_SOFTWARE_POLLING :
   *						 ADC sampling is triggered by software
   *						 ADC software startup trigger program is started in TIM2 (2000Hz)timer interrupt. 
-  *						 Specific parameters of TIM2 are as follows:
-  *						 APB1_Timer_Clock 100MHz = 100*1000000 PSC:1000-1 ARR:50-1 
+  *
+  *						 ADC_MODE_DMA_BLOCK :
+  *						 Every regular scan is triggered by TIM2 TRGO (update event), no CPU is involved per sample.
+  *						 DMA2_Stream0 runs in circular mode over a ping-pong buffer of two blocks,
+  *						 one block holds the frames of the sampling profile, ADC_BLOCK_FRAME_MAX_NUM at most.
+  *						 The half transfer and transfer complete interrupts hand the finished half (one block)
+  *						 to the processing layer through ADC_BlockReady_Callback, while DMA fills the other half.
+  *
+  *						 Specific parameters of TIM2 are set by the sampling profile, default (2000Hz):
+  *						 APB1_Timer_Clock 72MHz = 72*1000000 PSC:72-1 ARR:500-1 
   * parameter          :
   * 					 ADC1:Preenmption Priority 0
 							 mode: IN1  -- PA1
@@ -82,11 +91,26 @@
 #include "adc.h"
 #include "dma.h"
 #include "tim.h"
+#include "DigtalSignal_Process.h"
 
 /* External function declaration----------------------------------------------*/
 
 /* Private macro definitions--------------------------------------------------*/
 
+/* No sampling profile switch is pending */
+#define ADC_PROFILE_NONE                0xFFU
+
+#if(ADC_VREF_INJECTED_USED == 0)
+/* Rank of the internal reference voltage in one frame */
+#define ADC_VREF_RANK                   (ADC_SCAN_RANK_NUM - 1)
+#endif
+/* 
+	The calibration scale is a Q15 fraction with a left shift of 1 (Q1.14),
+	so VDDA up to 2*RANGE_12BITS mV can be represented
+*/
+#define ADC_CALIBRATION_SHIFT           1
+#define ADC_CALIBRATION_Q               (15 - ADC_CALIBRATION_SHIFT)
+
 /* Global variable------------------------------------------------------------*/
 
 /* External variable: handle of ADC1 */
@@ -94,30 +118,182 @@ extern ADC_HandleTypeDef hadc1;
 /* External variable: handle of TIM2 */
 extern TIM_HandleTypeDef htim2;
 
+#if(ADC_ACQUISITION_MODE == ADC_MODE_SOFTWARE_POLLING)
 /* Variable containing ADC conversions results */
 static __IO uint16_t   aADCxConvertedValues[ADCCONVERTEDVALUES_BUFFER_SIZE];
-/* Variables for ADC conversions results computation to physical values */
-static uint16_t   uhADCChannel_1_ToDAC_mVolt 	= 0;
-static uint16_t   uhADCChannel_3_ToDAC_mVolt 	= 0;
-static uint16_t   uhADCChannel_5_ToDAC_mVolt 	= 0;
-static uint16_t   uhADCChannel_6_ToDAC_mVolt 	= 0;
-static uint16_t   uhADCChannel_Vref_ToDAC_mVolt = 0;
+/* Calibrated voltage (unit: mV) of the latest scan, the channel views point here */
+static uint16_t        aADCxCalibratedFrame[ADC_SCAN_RANK_NUM];
+/* Set once the first scan is calibrated */
+static volatile bool   ADC_CalibratedFrame_Flag = (bool)FALSE;
+#else
+/* DMA ping-pong buffer: the first half and the second half each hold one block of frames */
+static __IO uint16_t   aADCxBlockBuffer[ADC_BLOCK_BUFFER_SIZE];
+/* Start address of the latest block completely written by DMA, NULL before the first block */
+static uint16_t* volatile p_LatestBlock = NULL;
+/* Calibrated voltage (unit: mV) of every sample, same layout as the DMA ping-pong buffer */
+static uint16_t        aADCxCalibratedBuffer[ADC_BLOCK_BUFFER_SIZE];
+/* Start address of the latest calibrated block, NULL before the first block */
+static uint16_t* volatile p_LatestCalibratedBlock = NULL;
+/* Timestamp of the last frame of the latest block (taken in the DMA interrupt), unit: us */
+static volatile uint32_t ADC_Block_Timestamp = 0;
+#endif
+
+/* Calibration scale of the latest block (Q1.14) and the VDDA it was computed from (unit: mV) */
+static volatile int16_t  ADC_Calibration_Fract = (int16_t)((VDD_APPLI << ADC_CALIBRATION_Q) / RANGE_12BITS);
+static volatile uint16_t ADC_VDDA_mVolt        = VDD_APPLI;
+/* Calibrated voltage of Vref used for the latest block, unit: mV */
+static volatile uint16_t ADC_VrefInt_mVolt     = 0;
+
+/* 
+	Sampling profile table
+	TIM2 clock = APB1 timer clock 72MHz, PSC:72-1 gives a 1MHz count clock, so ARR+1 is the sampling period in us.
+	ADC clock = PCLK2/2 = 36MHz, the sample time is the longest one that keeps the 5-rank scan 
+	within a quarter of the sampling period: 5*(Sampling time + 12 cycles) < Sampling period/4.
+	One DMA block always holds 10 ms of data (5 ms at 20000Hz, limited by ADC_BLOCK_FRAME_MAX_NUM).
+	20000Hz only fits with the 4-rank scan: 4*(84 + 12) = 384 cycles < 450 cycles.
+*/
+static const ADC_SampleProfile ADC_SampleProfile_Table[ADC_PROFILE_NUM] =
+{
+	/* Sample_Rate  TIM_Prescaler  TIM_Period  Sampling_Time             Block_Frame_Num */
+	{  2000,        72-1,          500-1,      ADC_SAMPLETIME_480CYCLES,   20 },
+	{  4000,        72-1,          250-1,      ADC_SAMPLETIME_144CYCLES,   40 },
+	{  8000,        72-1,          125-1,      ADC_SAMPLETIME_144CYCLES,   80 },
+	{ 10000,        72-1,          100-1,      ADC_SAMPLETIME_144CYCLES,  100 },
+#if(ADC_VREF_INJECTED_USED == 1)
+	{ 20000,        72-1,           50-1,      ADC_SAMPLETIME_84CYCLES,   100 },
+#endif
+};
+
+/* Channels converted by ranks 1 to ADC_SCAN_RANK_NUM, Vref is not used by the 4-rank scan */
+static const uint32_t ADC_Rank_Channel[] =
+{
+	ADC_CHANNEL_1, ADC_CHANNEL_3, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_VREFINT
+};
+
+/* Current sampling profile */
+static ADC_SampleProfile_ID ADC_Profile_ID          = ADC_SAMPLE_PROFILE_DEFAULT;
+/* Number of frames in one DMA block of the current sampling profile */
+static volatile uint32_t    ADC_Block_FrameNum      = 20;
+/* Sampling profile requested by the upper computer, ADC_PROFILE_NONE if no request */
+static volatile uint8_t     ADC_Profile_Pending_ID  = ADC_PROFILE_NONE;
+
+/* Oversampling state of every rank, set to no oversampling (ratio 1) in ADC_Operation_Init */
+static ADC_Oversampling     ADC_Oversampling_State[ADC_SCAN_RANK_NUM];
+/* Set while TIM2 and the ADC-DMA transfer are running */
+static volatile bool        ADC_Acquisition_Running = (bool)FALSE;
+
+#if(ADC_VREF_INJECTED_USED == 1)
+/* Injected Vref readout filtered by a first order low pass (1/4), 16 times the ADC code, 0 before the first conversion */
+static volatile uint32_t    ADC_Vref_Injected_Q4    = 0;
+/* Number of ticks between two injected Vref conversions, and the ticks counted so far */
+static volatile uint32_t    ADC_Vref_Tick_Divider   = ADC_VREF_TICK_RATE / ADC_VREF_RATE_DEFAULT;
+static uint32_t             ADC_Vref_Tick_Count     = 0;
+#endif
 /* Variable to report ADC sequencer status */
 uint8_t ubSequenceCompleted = RESET;     /* Set when all ranks of the sequence have been converted */
 
 /* Static function definition-------------------------------------------------*/
 
-/* The function uses the reference voltage to calibrate the voltage value collected by the ADC channel */
-static uint16_t ADC_Calibration(uint16_t V_Channel , uint16_t V_Ref);
+/* Use the reference voltage of a whole block to calibrate the voltage values of all ranks */
+static void ADC_Block_Calibration(const uint16_t* p_Block, uint16_t* p_DstBuff, uint32_t Frame_Num);
+/* Obtain the newest sample of one channel view */
+static t_FuncRet ADC_Get_Channel_Latest(ADC_Channel_ID Channel, uint16_t* p_Data);
+/* Start TIM2 and the ADC-DMA transfer */
+static t_FuncRet ADC_Acquisition_Start(void);
+/* Stop TIM2 and the ADC-DMA transfer */
+static t_FuncRet ADC_Acquisition_Stop(void);
 
 /* Function definition--------------------------------------------------------*/
 
+#if(ADC_ACQUISITION_MODE == ADC_MODE_SOFTWARE_POLLING)
+
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *AdcHandle)
 {
   /* Report to main program that ADC sequencer has reached its end */
   ubSequenceCompleted = SET;
 }
 
+#else
+
+/**
+  * @brief  DMA has filled the first half of the ping-pong buffer, 
+  *         which is handed over while the second half is being filled
+  * @param  AdcHandle : ADC handle
+  * @retval None
+  */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *AdcHandle)
+{
+	/* The last frame of the block has just been converted */
+	ADC_Block_Timestamp = GET_TIMESTAMP_US();
+	
+	ADC_Block_Calibration((uint16_t*)&aADCxBlockBuffer[0], &aADCxCalibratedBuffer[0], ADC_Block_FrameNum);
+	
+	p_LatestCalibratedBlock = &aADCxCalibratedBuffer[0];
+	p_LatestBlock           = (uint16_t*)&aADCxBlockBuffer[0];
+	
+	ADC_BlockReady_Callback((uint16_t*)p_LatestBlock, ADC_Block_FrameNum);
+}
+
+/**
+  * @brief  DMA has filled the second half of the ping-pong buffer,
+  *         which is handed over while the first half is being filled again
+  * @param  AdcHandle : ADC handle
+  * @retval None
+  */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *AdcHandle)
+{
+	uint32_t Offset = ADC_Block_FrameNum*ADC_SCAN_RANK_NUM;
+	
+	/* The last frame of the block has just been converted */
+	ADC_Block_Timestamp = GET_TIMESTAMP_US();
+	
+	ADC_Block_Calibration((uint16_t*)&aADCxBlockBuffer[Offset], &aADCxCalibratedBuffer[Offset], ADC_Block_FrameNum);
+	
+	p_LatestCalibratedBlock = &aADCxCalibratedBuffer[Offset];
+	p_LatestBlock           = (uint16_t*)&aADCxBlockBuffer[Offset];
+	
+	ADC_BlockReady_Callback((uint16_t*)p_LatestBlock, ADC_Block_FrameNum);
+}
+
+#endif
+
+/** 
+* @description: A block of DMA frames is complete and handed to the processing layer.
+*				The block holds Frame_Num frames of ADC_SCAN_RANK_NUM interleaved ranks 
+*				and stays valid until DMA comes back to it, that is one block time later.
+*				Called in the DMA interrupt, the processing layer overrides this weak definition.
+* @param  {uint16_t*} p_Block   : Start address of the finished block
+* @param  {uint32_t}  Frame_Num : Number of frames in the block
+* @return {void} 
+* @author: leeqingshui 
+*/
+__weak void ADC_BlockReady_Callback(uint16_t* p_Block, uint32_t Frame_Num)
+{
+	UNUSED(p_Block);
+	UNUSED(Frame_Num);
+}
+
+#if(ADC_VREF_INJECTED_USED == 1)
+/**
+  * @brief  The injected Vref conversion is complete
+  * @param  AdcHandle : ADC handle
+  * @retval None
+  */
+void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *AdcHandle)
+{
+	uint32_t Vref_Raw = HAL_ADCEx_InjectedGetValue(AdcHandle, ADC_INJECTED_RANK_1);
+	
+	if(ADC_Vref_Injected_Q4 == 0)
+	{
+		ADC_Vref_Injected_Q4 = Vref_Raw << 4;
+	}
+	else
+	{
+		ADC_Vref_Injected_Q4 = ADC_Vref_Injected_Q4 - (ADC_Vref_Injected_Q4 >> 2) + (Vref_Raw << 2);
+	}
+}
+#endif
+
 /** 
 * @description: Initialize ADC related peripherals: ADC GPIO port and DMA channel
 * @param  {void} 
@@ -140,10 +316,89 @@ t_FuncRet  ADC_Operation_Init(void)
 		and Implementation of ADC timing multi - channel sampling conversion
 	*/
 	
+	/* No oversampling after power on */
+	for(uint8_t rank = 0; rank < ADC_SCAN_RANK_NUM; rank++)
+	{
+		ADC_Set_Oversampling(rank, 1);
+	}
+	
+#if(ADC_ACQUISITION_MODE == ADC_MODE_DMA_BLOCK)
+	
+	TIM_MasterConfigTypeDef sMasterConfig = {0};
+	
+	/* 
+		The whole scan is started by the TIM2 update event (TRGO), 
+		discontinuous mode is turned off so that one trigger converts all ranks
+	*/
+	hadc1.Init.DiscontinuousConvMode = DISABLE;
+	hadc1.Init.ExternalTrigConv      = ADC_EXTERNALTRIGCONV_T2_TRGO;
+	hadc1.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_RISING;
+	hadc1.Init.NbrOfConversion       = ADC_SCAN_RANK_NUM;
+	if(HAL_ADC_Init(&hadc1) != HAL_OK)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+#if(ADC_VREF_INJECTED_USED == 1)
+	
+	ADC_InjectionConfTypeDef sConfigInjected = {0};
+	
+	/* 
+		Vref is the only injected channel, started by software from ADC_VrefInjected_Tick.
+		It interrupts the regular scan between two conversions, the regular scan goes on afterwards.
+		The VREFINT sample time must be at least 10us: 480 cycles / 36MHz = 13.3us
+	*/
+	sConfigInjected.InjectedChannel               = ADC_CHANNEL_VREFINT;
+	sConfigInjected.InjectedRank                  = ADC_INJECTED_RANK_1;
+	sConfigInjected.InjectedNbrOfConversion       = 1;
+	sConfigInjected.InjectedSamplingTime          = ADC_SAMPLETIME_480CYCLES;
+	sConfigInjected.ExternalTrigInjecConv         = ADC_INJECTED_SOFTWARE_START;
+	sConfigInjected.ExternalTrigInjecConvEdge     = ADC_EXTERNALTRIGINJECCONVEDGE_NONE;
+	sConfigInjected.AutoInjectedConv              = DISABLE;
+	sConfigInjected.InjectedDiscontinuousConvMode = DISABLE;
+	sConfigInjected.InjectedOffset                = 0;
+	if(HAL_ADCEx_InjectedConfigChannel(&hadc1, &sConfigInjected) != HAL_OK)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+#endif
+	
+	/* TIM2 outputs its update event as TRGO */
+	sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+	sMasterConfig.MasterSlaveMode     = TIM_MASTERSLAVEMODE_DISABLE;
+	if(HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+#endif
+	
+	/* Program TIM2, the sample time and the block size of the default sampling profile, then start sampling */
+	ret = ADC_Set_SampleProfile(ADC_SAMPLE_PROFILE_DEFAULT);
+	
+	/* The flag bit reset of ADC1 collection is complete */
+	ubSequenceCompleted = RESET;
+	
+	return ret;
+}
+
+/** 
+* @description: Start TIM2 and the ADC-DMA transfer
+* @param  {void} 
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+static t_FuncRet ADC_Acquisition_Start(void)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+#if(ADC_ACQUISITION_MODE == ADC_MODE_SOFTWARE_POLLING)
+
 	/* Clear the IT flag bit */
 	__HAL_TIM_CLEAR_IT(&htim2,TIM_IT_UPDATE ); 
 
-	/* Enable timer 3 Interrupt */
+	/* Enable timer 2 Interrupt */
 	if(HAL_TIM_Base_Start_IT(&htim2)!=HAL_OK)
 	{
 		return ret= (t_FuncRet)Operation_Fail;
@@ -158,12 +413,327 @@ t_FuncRet  ADC_Operation_Init(void)
 		return ret= (t_FuncRet)Operation_Fail;
 	}
 	
-	/* The flag bit reset of ADC1 collection is complete */
-	ubSequenceCompleted = RESET;
+#else
+	
+	/* DMA fills the ping-pong buffer in circular mode, half transfer and transfer complete interrupts are used */
+	p_LatestBlock           = NULL;
+	p_LatestCalibratedBlock = NULL;
+    if (HAL_ADC_Start_DMA(&hadc1,
+						  (uint32_t *)aADCxBlockBuffer,
+                          2*ADC_Block_FrameNum*ADC_SCAN_RANK_NUM
+                         ) != HAL_OK)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	/* 
+		Start timer 2 last: the first TRGO starts the first scan. 
+		The update interrupt is not used, the frames are handed over block by block through the sample ring
+	*/
+	if(HAL_TIM_Base_Start(&htim2)!=HAL_OK)
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+#endif
+
+	ADC_Acquisition_Running = (bool)TRUE;
 	
 	return ret;
 }
 
+/** 
+* @description: Stop TIM2 and the ADC-DMA transfer
+* @param  {void} 
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+static t_FuncRet ADC_Acquisition_Stop(void)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	/* The injected Vref conversion must not turn the ADC on again while it is stopped */
+	ADC_Acquisition_Running = (bool)FALSE;
+	
+	/* Stop the trigger source first so that no scan is started while DMA is stopped */
+#if(ADC_ACQUISITION_MODE == ADC_MODE_SOFTWARE_POLLING)
+	if(HAL_TIM_Base_Stop_IT(&htim2) != HAL_OK)
+#else
+	if(HAL_TIM_Base_Stop(&htim2) != HAL_OK)
+#endif
+	{
+		ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	/* The DMA can only be aborted while it is running (it is not yet started at power on) */
+	if(HAL_DMA_GetState(hadc1.DMA_Handle) == HAL_DMA_STATE_BUSY)
+	{
+		if(HAL_ADC_Stop_DMA(&hadc1) != HAL_OK)
+		{
+			ret= (t_FuncRet)Operation_Fail;
+		}
+	}
+	
+	return ret;
+}
+
+/** 
+* @description: Switch the sampling profile: TIM2 period, ADC sample time and DMA block size are reprogrammed together.
+*				Sampling stops for a few microseconds, the block being filled is dropped
+* @param  {ADC_SampleProfile_ID} Profile_ID : Sampling profile number
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Set_SampleProfile(ADC_SampleProfile_ID Profile_ID)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	ADC_ChannelConfTypeDef sConfig = {0};
+	const ADC_SampleProfile* p_Profile = NULL;
+	
+	if(!IS_ADC_SAMPLE_PROFILE(Profile_ID))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	p_Profile = &ADC_SampleProfile_Table[Profile_ID];
+	
+	ret = ADC_Acquisition_Stop();
+	if(ret == Operation_Fail)
+	{
+		return ret;
+	}
+	
+	/* Sample time of every rank */
+	sConfig.SamplingTime = p_Profile->Sampling_Time;
+	for(uint32_t rank = 0; rank < ADC_SCAN_RANK_NUM; rank++)
+	{
+		sConfig.Channel = ADC_Rank_Channel[rank];
+		sConfig.Rank    = rank + 1;
+		if(HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+		{
+			return ret= (t_FuncRet)Operation_Fail;
+		}
+	}
+	
+	/* TIM2 period, loaded at once by the update generation (the ADC is stopped, the TRGO is ignored) */
+	__HAL_TIM_SET_PRESCALER(&htim2, p_Profile->TIM_Prescaler);
+	__HAL_TIM_SET_AUTORELOAD(&htim2, p_Profile->TIM_Period);
+	__HAL_TIM_SET_COUNTER(&htim2, 0);
+	htim2.Instance->EGR = TIM_EGR_UG;
+	
+	/* DMA block size */
+	ADC_Block_FrameNum = p_Profile->Block_Frame_Num;
+	ADC_Profile_ID     = Profile_ID;
+	
+	/* Partial oversampling sums belong to the old sampling rate */
+	ADC_Oversampling_Reset();
+	
+	ret = ADC_Acquisition_Start();
+	
+	return ret;
+}
+
+/** 
+* @description: Request a sampling profile switch. 
+*				Only the number is recorded, so it can be called in the USB receive interrupt,
+*				the switch is done by ADC_SampleProfile_Process in the main loop
+* @param  {uint8_t} Profile_ID : Sampling profile number
+* @return {t_FuncRet } : if the number is correct,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Request_SampleProfile(uint8_t Profile_ID)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	if(!IS_ADC_SAMPLE_PROFILE(Profile_ID))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	ADC_Profile_Pending_ID = Profile_ID;
+	
+	return ret;
+}
+
+/** 
+* @description: Apply a pending sampling profile switch, called in the main loop
+* @param  {void} 
+* @return {t_FuncRet } : Operation_Success - a switch is done, Operation_Wait - no switch is pending, 
+*						 Operation_Fail - the switch failed
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_SampleProfile_Process(void)
+{
+	uint8_t Profile_ID = ADC_Profile_Pending_ID;
+	
+	if(Profile_ID == ADC_PROFILE_NONE)
+	{
+		return (t_FuncRet)Operation_Wait;
+	}
+	
+	ADC_Profile_Pending_ID = ADC_PROFILE_NONE;
+	
+	return ADC_Set_SampleProfile((ADC_SampleProfile_ID)Profile_ID);
+}
+
+/** 
+* @description: Return the current sampling profile number
+* @param  {void} 
+* @return {ADC_SampleProfile_ID} : Sampling profile number
+* @author: leeqingshui 
+*/
+ADC_SampleProfile_ID ADC_Get_SampleProfile(void)
+{
+	return ADC_Profile_ID;
+}
+
+/** 
+* @description: Return the sampling rate actually achieved by TIM2, 
+*				computed from the running clock tree and the TIM2 registers
+* @param  {void} 
+* @return {uint32_t} : Sampling rate of every channel, unit: Hz
+* @author: leeqingshui 
+*/
+uint32_t ADC_Get_SampleRate(void)
+{
+	uint32_t TIM_Clock = HAL_RCC_GetPCLK1Freq();
+	
+	/* The timer clock is twice PCLK1 when APB1 is divided */
+	if((RCC->CFGR & RCC_CFGR_PPRE1_2) != 0U)
+	{
+		TIM_Clock = TIM_Clock*2;
+	}
+	
+	return TIM_Clock/((htim2.Instance->PSC + 1)*(htim2.Instance->ARR + 1));
+}
+
+/** 
+* @description: Return the number of frames in one DMA block of the current sampling profile
+* @param  {void} 
+* @return {uint32_t} : Number of frames
+* @author: leeqingshui 
+*/
+uint32_t ADC_Get_BlockFrameNum(void)
+{
+	return ADC_Block_FrameNum;
+}
+
+/** 
+* @description: Set the oversampling ratio of one rank. 
+*				Each output sample is the sum of Ratio raw conversions shifted right, 
+*				every 4 times oversampling adds one effective bit. Ratio 1 turns oversampling off
+* @param  {uint8_t}  Rank  : Rank in the scan, 0 ~ ADC_SCAN_RANK_NUM-1
+* @param  {uint16_t} Ratio : Oversampling ratio, a power of 2 in 1 ~ ADC_OVERSAMPLING_RATIO_MAX
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Set_Oversampling(uint8_t Rank, uint16_t Ratio)
+{
+	t_FuncRet ret= (t_FuncRet)Operation_Success;
+	
+	ADC_Oversampling* p_State = NULL;
+	uint8_t Ratio_Log2 = 0;
+	uint32_t PriMask   = 0;
+	
+	if((Rank >= ADC_SCAN_RANK_NUM) || !IS_ADC_OVERSAMPLING_RATIO(Ratio))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	while((1U << Ratio_Log2) < Ratio)
+	{
+		Ratio_Log2++;
+	}
+	
+	p_State = &ADC_Oversampling_State[Rank];
+	
+	/* The block callback must not see a half updated state, the caller may already mask interrupts */
+	PriMask = __get_PRIMASK();
+	__disable_irq();
+	p_State->Ratio = Ratio;
+	p_State->Bits  = 12 + Ratio_Log2/2;
+	p_State->Shift = Ratio_Log2 - Ratio_Log2/2;
+	p_State->Count = 0;
+	p_State->Sum   = 0;
+	__set_PRIMASK(PriMask);
+	
+	return ret;
+}
+
+/** 
+* @description: Return the effective resolution of the oversampled data of one rank
+* @param  {uint8_t} Rank : Rank in the scan, 0 ~ ADC_SCAN_RANK_NUM-1
+* @return {uint8_t}      : Effective resolution, unit: bits
+* @author: leeqingshui 
+*/
+uint8_t ADC_Get_Oversampling_Bits(uint8_t Rank)
+{
+	if(Rank >= ADC_SCAN_RANK_NUM)
+	{
+		return 0;
+	}
+	
+	return ADC_Oversampling_State[Rank].Bits;
+}
+
+/** 
+* @description: Clear the partial sums of all ranks, the ratios are kept
+* @param  {void} 
+* @return {void} 
+* @author: leeqingshui 
+*/
+void ADC_Oversampling_Reset(void)
+{
+	for(uint32_t rank = 0; rank < ADC_SCAN_RANK_NUM; rank++)
+	{
+		ADC_Oversampling_State[rank].Count = 0;
+		ADC_Oversampling_State[rank].Sum   = 0;
+	}
+}
+
+/** 
+* @description: Oversample and decimate one rank of a DMA block, called on the block boundary.
+*				The partial sum is carried to the next block, so the ratio does not need 
+*				to divide the number of frames in a block
+* @param  {uint16_t*} p_Block   : Start address of the block (interleaved frames)
+* @param  {uint32_t}  Frame_Num : Number of frames in the block
+* @param  {uint8_t}   Rank      : Rank in the scan, 0 ~ ADC_SCAN_RANK_NUM-1
+* @param  {uint16_t*} p_DstBuff : Output samples, at least Frame_Num/Ratio + 1 elements
+* @return {uint32_t}            : Number of output samples
+* @author: leeqingshui 
+*/
+uint32_t ADC_Oversampling_Block(const uint16_t* p_Block, uint32_t Frame_Num, uint8_t Rank, uint16_t* p_DstBuff)
+{
+	ADC_Oversampling* p_State = &ADC_Oversampling_State[Rank];
+	const uint16_t*   p_Src   = p_Block + Rank;
+	
+	uint32_t Sum     = p_State->Sum;
+	uint32_t Count   = p_State->Count;
+	uint32_t Ratio   = p_State->Ratio;
+	uint32_t Shift   = p_State->Shift;
+	uint32_t Out_Num = 0;
+	
+	for(uint32_t i = 0; i < Frame_Num; i++)
+	{
+		Sum = Sum + *p_Src;
+		p_Src = p_Src + ADC_SCAN_RANK_NUM;
+		
+		Count++;
+		if(Count == Ratio)
+		{
+			p_DstBuff[Out_Num++] = (uint16_t)(Sum >> Shift);
+			Sum   = 0;
+			Count = 0;
+		}
+	}
+	
+	p_State->Sum   = Sum;
+	p_State->Count = (uint16_t)Count;
+	
+	return Out_Num;
+}
+
 /** 
 * @description: Obtain the voltage values collected by the 2 channels
 * @param  {void} 
@@ -174,6 +744,25 @@ t_FuncRet ADC_Get_Data(void)
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
+#if(ADC_ACQUISITION_MODE == ADC_MODE_DMA_BLOCK)
+	
+	/* Conversion runs without the CPU, take the newest frame of the latest calibrated block */
+	uint16_t* p_Frame = p_LatestCalibratedBlock;
+	
+	if(p_Frame == NULL)
+	{
+		/* No block completed yet, LED off */
+		HAL_GPIO_WritePin(LD4_GPIO_Port,LD4_Pin,GPIO_PIN_RESET);
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	/* The block is already calibrated to mV in the DMA interrupt, the channel views read it in place */
+	HAL_GPIO_WritePin(LD4_GPIO_Port,LD4_Pin,GPIO_PIN_SET);
+	
+	return ret;
+	
+#else
+	
 	HAL_ADC_Start(&hadc1);
 	
 	/* Wait for conversion completion before conditional check hereafter */
@@ -191,109 +780,313 @@ t_FuncRet ADC_Get_Data(void)
 	
 	  HAL_GPIO_WritePin(LD4_GPIO_Port,LD4_Pin,GPIO_PIN_SET);
 		
-      uhADCChannel_1_ToDAC_mVolt    = COMPUTATION_DIGITAL_12BITS_TO_VOLTAGE(aADCxConvertedValues[0]);
-      uhADCChannel_3_ToDAC_mVolt    = COMPUTATION_DIGITAL_12BITS_TO_VOLTAGE(aADCxConvertedValues[1]);
-	  uhADCChannel_5_ToDAC_mVolt    = COMPUTATION_DIGITAL_12BITS_TO_VOLTAGE(aADCxConvertedValues[2]);
-      uhADCChannel_6_ToDAC_mVolt    = COMPUTATION_DIGITAL_12BITS_TO_VOLTAGE(aADCxConvertedValues[3]);
-	  uhADCChannel_Vref_ToDAC_mVolt = COMPUTATION_DIGITAL_12BITS_TO_VOLTAGE(aADCxConvertedValues[4]);
+	  /* One scan is calibrated as a block of one frame */
+	  ADC_Block_Calibration((uint16_t*)aADCxConvertedValues, aADCxCalibratedFrame, 1);
+	  ADC_CalibratedFrame_Flag = (bool)TRUE;
 		
 	  ubSequenceCompleted = RESET;
       ret= (t_FuncRet)Operation_Success;
 	}
 	
 	return ret;
+	
+#endif
 }
 
 /** 
-* @description: Obtain the voltage of no. 1 EMG sensor 
-* @param  {float} Sensor_V_Data : the voltage of no. 1 EMG sensor 
-* @return {t_FuncRet}           : if success,return Operation_Success
+* @description: Obtain a view of one channel in the latest calibrated data, no data are copied.
+*				Sample i of the channel is p_View->p_Data[i*p_View->Stride], unit: mV.
+*				In ADC_MODE_DMA_BLOCK the view covers the latest block and stays valid for one block time,
+*				after that DMA overwrites it. In ADC_MODE_SOFTWARE_POLLING it covers the latest scan (1 sample).
+*				An injected Vref has no rank in the block, its view repeats the value of the block (Stride 0)
+* @param  {ADC_Channel_ID}    Channel : Channel of the view
+* @param  {ADC_Channel_View*} p_View  : The view
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no data converted yet
 * @author: leeqingshui 
 */
-t_FuncRet ADC_Get_SensorData_1(uint16_t* p_Sensor_V_Data)
+t_FuncRet ADC_Get_Channel_View(ADC_Channel_ID Channel, ADC_Channel_View* p_View)
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	*p_Sensor_V_Data =  uhADCChannel_1_ToDAC_mVolt;
+	const uint16_t* p_Data = NULL;
+	uint32_t        Length = 0;
+	
+	if(!IS_ADC_CHANNEL_ID(Channel))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+#if(ADC_ACQUISITION_MODE == ADC_MODE_DMA_BLOCK)
+	p_Data = p_LatestCalibratedBlock;
+	Length = ADC_Block_FrameNum;
+#else
+	p_Data = (ADC_CalibratedFrame_Flag == (bool)TRUE) ? aADCxCalibratedFrame : NULL;
+	Length = 1;
+#endif
+	
+	if(p_Data == NULL)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+#if(ADC_VREF_INJECTED_USED == 1)
+	if(Channel == ADC_CHANNEL_ID_VREF)
+	{
+		p_View->p_Data = (const uint16_t*)&ADC_VrefInt_mVolt;
+		p_View->Stride = 0;
+		p_View->Length = Length;
+		
+		return ret;
+	}
+#endif
+	
+	p_View->p_Data = p_Data + (uint32_t)Channel;
+	p_View->Stride = ADC_SCAN_RANK_NUM;
+	p_View->Length = Length;
 	
 	return ret;
 }
 
 /** 
-* @description: Obtain the voltage of no. 2 EMG sensor 
-* @param  {float} Sensor_V_Data : the voltage of no. 1 EMG sensor 
-* @return {t_FuncRet}           : if success,return Operation_Success
+* @description: Obtain the voltage of no. 1 EMG sensor: the newest sample of its channel view
+* @param  {uint16_t*} p_Sensor_V_Data : the voltage of no. 1 EMG sensor, unit: mV
+* @return {t_FuncRet}                 : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Get_SensorData_1(uint16_t* p_Sensor_V_Data)
+{
+	return ADC_Get_Channel_Latest(ADC_CHANNEL_ID_SENSOR_1, p_Sensor_V_Data);
+}
+
+/** 
+* @description: Obtain the voltage of no. 2 EMG sensor: the newest sample of its channel view
+* @param  {uint16_t*} p_Sensor_V_Data : the voltage of no. 2 EMG sensor, unit: mV
+* @return {t_FuncRet}                 : if success,return Operation_Success
 * @author: leeqingshui 
 */
 t_FuncRet ADC_Get_SensorData_2(uint16_t* p_Sensor_V_Data)
 {
-	t_FuncRet ret= (t_FuncRet)Operation_Success;
-	
-	*p_Sensor_V_Data = uhADCChannel_3_ToDAC_mVolt;
-	
-	return ret;
+	return ADC_Get_Channel_Latest(ADC_CHANNEL_ID_SENSOR_2, p_Sensor_V_Data);
 }
 
 /** 
-* @description: Obtain the voltage of no. 3 EMG sensor 
-* @param  {float} Sensor_V_Data : the voltage of no. 1 EMG sensor 
-* @return {t_FuncRet}           : if success,return Operation_Success
+* @description: Obtain the voltage of no. 3 EMG sensor: the newest sample of its channel view
+* @param  {uint16_t*} p_Sensor_V_Data : the voltage of no. 3 EMG sensor, unit: mV
+* @return {t_FuncRet}                 : if success,return Operation_Success
 * @author: leeqingshui 
 */
 t_FuncRet ADC_Get_SensorData_3(uint16_t* p_Sensor_V_Data)
+{
+	return ADC_Get_Channel_Latest(ADC_CHANNEL_ID_SENSOR_3, p_Sensor_V_Data);
+}
+
+/** 
+* @description: Obtain the voltage of no. 4 EMG sensor: the newest sample of its channel view
+* @param  {uint16_t*} p_Sensor_V_Data : the voltage of no. 4 EMG sensor, unit: mV
+* @return {t_FuncRet}                 : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Get_SensorData_4(uint16_t* p_Sensor_V_Data)
+{
+	return ADC_Get_Channel_Latest(ADC_CHANNEL_ID_SENSOR_4, p_Sensor_V_Data);
+}
+
+/** 
+* @description: Obtain the voltage of Vref: the newest sample of its channel view
+* @param  {uint16_t*} p_Vref : Vref, unit: mV
+* @return {t_FuncRet}        : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Get_Vref(uint16_t* p_Vref)
+{
+	return ADC_Get_Channel_Latest(ADC_CHANNEL_ID_VREF, p_Vref);
+}
+
+/** 
+* @description: Obtain the newest sample of one channel view
+* @param  {ADC_Channel_ID} Channel : Channel of the view
+* @param  {uint16_t*}      p_Data  : The newest sample, unit: mV
+* @return {t_FuncRet}              : Operation_Success, Operation_Wait if no data converted yet
+* @author: leeqingshui 
+*/
+static t_FuncRet ADC_Get_Channel_Latest(ADC_Channel_ID Channel, uint16_t* p_Data)
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	*p_Sensor_V_Data =  uhADCChannel_5_ToDAC_mVolt;
+	ADC_Channel_View View;
+	
+	ret = ADC_Get_Channel_View(Channel, &View);
+	if(ret != (t_FuncRet)Operation_Success)
+	{
+		return ret;
+	}
+	
+	*p_Data = View.p_Data[(View.Length - 1)*View.Stride];
 	
 	return ret;
 }
 
 /** 
-* @description: Obtain the voltage of no. 4 EMG sensor 
-* @param  {float} Sensor_V_Data : the voltage of no. 1 EMG sensor 
-* @return {t_FuncRet}           : if success,return Operation_Success
+* @description: Return the VDDA computed from the reference voltage of the latest block
+* @param  {void} 
+* @return {uint16_t} : VDDA, unit: mV
 * @author: leeqingshui 
 */
-t_FuncRet ADC_Get_SensorData_4(uint16_t* p_Sensor_V_Data)
+uint16_t ADC_Get_VDDA(void)
+{
+	return ADC_VDDA_mVolt;
+}
+
+/** 
+* @description: Return the calibrated voltage of Vref used for the latest block
+* @param  {void} 
+* @return {uint16_t} : Vref, unit: mV
+* @author: leeqingshui 
+*/
+uint16_t ADC_Get_VrefInt(void)
+{
+	return ADC_VrefInt_mVolt;
+}
+
+#if(ADC_VREF_INJECTED_USED == 1)
+/** 
+* @description: Set the injected Vref conversion rate, it is rounded down to ADC_VREF_TICK_RATE/n
+* @param  {uint32_t} Rate : Conversion rate, 1 - ADC_VREF_TICK_RATE, unit: Hz
+* @return {t_FuncRet } : if success,return Operation_Success
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Set_VrefRate(uint32_t Rate)
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	*p_Sensor_V_Data = uhADCChannel_6_ToDAC_mVolt;
+	if(!IS_ADC_VREF_RATE(Rate))
+	{
+		return ret= (t_FuncRet)Operation_Fail;
+	}
+	
+	ADC_Vref_Tick_Divider = ADC_VREF_TICK_RATE / Rate;
 	
 	return ret;
 }
 
 /** 
-* @description: Obtain the voltage of Vref
-* @param  {float} Sensor_V_Data : Vref 
-* @return {t_FuncRet}           : if success,return Operation_Success
+* @description: Start an injected Vref conversion every ADC_Vref_Tick_Divider ticks,
+*				called in the TIM3 interrupt (ADC_VREF_TICK_RATE).
+*				The injected conversion is only started while the regular scan is running,
+*				otherwise it would turn the stopped ADC on again
+* @param  {void} 
+* @return {void} 
 * @author: leeqingshui 
 */
-t_FuncRet ADC_Get_Vref(uint16_t* p_Vref)
+void ADC_VrefInjected_Tick(void)
+{
+	ADC_Vref_Tick_Count++;
+	if(ADC_Vref_Tick_Count < ADC_Vref_Tick_Divider)
+	{
+		return;
+	}
+	ADC_Vref_Tick_Count = 0;
+	
+	if(ADC_Acquisition_Running == (bool)TRUE)
+	{
+		HAL_ADCEx_InjectedStart_IT(&hadc1);
+	}
+}
+#endif
+
+#if(ADC_ACQUISITION_MODE == ADC_MODE_DMA_BLOCK)
+/** 
+* @description: Obtain the latest calibrated block, the voltage (unit: mV) of every rank of every frame.
+*				The layout is the same as the block handed to ADC_BlockReady_Callback
+* @param  {uint16_t**} pp_Block    : Start address of the calibrated block
+* @param  {uint32_t*}  p_Frame_Num : Number of frames in the block
+* @return {t_FuncRet } : Operation_Success, Operation_Wait if no block completed yet
+* @author: leeqingshui 
+*/
+t_FuncRet ADC_Get_CalibratedBlock(uint16_t** pp_Block, uint32_t* p_Frame_Num)
 {
 	t_FuncRet ret= (t_FuncRet)Operation_Success;
 	
-	*p_Vref = uhADCChannel_Vref_ToDAC_mVolt;
+	uint16_t* p_Block = p_LatestCalibratedBlock;
+	
+	if(p_Block == NULL)
+	{
+		return ret= (t_FuncRet)Operation_Wait;
+	}
+	
+	*pp_Block    = p_Block;
+	*p_Frame_Num = ADC_Block_FrameNum;
 	
 	return ret;
 }
 
 /** 
-* @description: uses the reference voltage to calibrate the voltage value collected by the ADC channel
-*				V_True = (VDD_APPLI*VREF_CAL*V_Channel)/V_Ref*RANGE_12BITS
-* @param  {uint16_t} V_Channel : You need to measure the channel using an ADC readout
-* @param  {uint16_t} V_Ref     : Internal reference voltage channel read value
-* @return {uint16_t} V_True
+* @description: Return the timestamp of the last frame of the latest block.
+*				Frame i of a block of N frames was converted at Timestamp - (N-1-i)*Sampling period
+* @param  {void} 
+* @return {uint32_t} : Timestamp, unit: us
+* @author: leeqingshui 
+*/
+uint32_t ADC_Get_BlockTimestamp(void)
+{
+	return ADC_Block_Timestamp;
+}
+#endif
+
+/** 
+* @description: Uses the reference voltage of a whole block to calibrate the voltage values of all ranks
+*				VDDA   = VDD_APPLI*VREF_CAL/Mean(V_Ref)
+*				V_True = V_Channel*VDDA/RANGE_12BITS
+*				The scale VDDA/RANGE_12BITS is computed once per block as a Q1.14 number,
+*				then all ranks are multiplied by it, no divide is done per sample
+* @param  {uint16_t*} p_Block   : Start address of the block (interleaved frames of ADC codes)
+* @param  {uint16_t*} p_DstBuff : Calibrated voltage of every sample, unit: mV
+* @param  {uint32_t}  Frame_Num : Number of frames in the block
+* @return {void} 
 * @author: leeqingshui 
 */
-static uint16_t ADC_Calibration(uint16_t V_Channel , uint16_t V_Ref)
+static void ADC_Block_Calibration(const uint16_t* p_Block, uint16_t* p_DstBuff, uint32_t Frame_Num)
 {
-	uint16_t V_True = 0;
+	uint32_t Vref_Sum = 0;
+	uint32_t Vref_Num = 0;
+	uint64_t Fract    = 0;
+	
+#if(ADC_VREF_INJECTED_USED == 1)
+	
+	/* The filtered injected readout is 16 times the ADC code */
+	Vref_Sum = ADC_Vref_Injected_Q4;
+	Vref_Num = 16;
 	
-	V_True = (VREF_CAL*V_Channel)/(V_Ref);
+#else
 	
-	return V_True;
+	const uint16_t* p_Vref = p_Block + ADC_VREF_RANK;
+	
+	for(uint32_t i = 0; i < Frame_Num; i++)
+	{
+		Vref_Sum = Vref_Sum + *p_Vref;
+		p_Vref   = p_Vref + ADC_SCAN_RANK_NUM;
+	}
+	Vref_Num = Frame_Num;
+	
+#endif
+	
+	/* Keep the scale of the last block if the reference voltage readout is invalid (or not converted yet) */
+	if(Vref_Sum != 0)
+	{
+		ADC_VDDA_mVolt = (uint16_t)(((uint32_t)VDD_APPLI*VREF_CAL*Vref_Num)/Vref_Sum);
+		
+		Fract = (((uint64_t)VDD_APPLI*VREF_CAL*Vref_Num) << ADC_CALIBRATION_Q)/((uint64_t)Vref_Sum*RANGE_12BITS);
+		if(Fract > INT16_MAX)
+		{
+			Fract = INT16_MAX;
+		}
+		ADC_Calibration_Fract = (int16_t)Fract;
+		
+		ADC_VrefInt_mVolt = (uint16_t)((((uint64_t)Vref_Sum*(uint16_t)ADC_Calibration_Fract)/Vref_Num) >> ADC_CALIBRATION_Q);
+	}
+	
+	/* 12 bits codes are positive Q15 numbers, the whole interleaved block is scaled at once */
+	Get_DataBuff_Scale_Q15((int16_t*)p_Block, ADC_Calibration_Fract, ADC_CALIBRATION_SHIFT, 
+						   (int16_t*)p_DstBuff, Frame_Num*ADC_SCAN_RANK_NUM);
 }
 
-
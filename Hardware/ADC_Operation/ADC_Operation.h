@@ -47,7 +47,66 @@
 /* Maximum value of variable "UserButtonClickCount" */
 #define RANGE_12BITS                   ((uint32_t) 4095)   
 /* Size of array containing ADC converted values: set to ADC sequencer number of ranks converted, to have a rank in each address */
-#define ADCCONVERTEDVALUES_BUFFER_SIZE ((uint32_t)    5)  
+#define ADCCONVERTEDVALUES_BUFFER_SIZE ((uint32_t)    5)
+
+/* ADC acquisition mode */
+/* Each scan is started by software in the TIM2 interrupt and polled until the end of conversion */
+#define ADC_MODE_SOFTWARE_POLLING       0U
+/* Each scan is started by TIM2 TRGO and DMA fills a circular ping-pong buffer of scan frames */
+#define ADC_MODE_DMA_BLOCK              1U
+
+/* Which acquisition mode is used */
+#define ADC_ACQUISITION_MODE            ADC_MODE_DMA_BLOCK
+
+/* 
+	Whether Vref is converted as an injected channel at a low rate instead of rank 5 of every regular scan.
+	Vref drifts slowly, so the regular scan only carries the 4 EMG channels and 
+	the recovered conversion time allows the 20000Hz sampling profile.
+	Only available in ADC_MODE_DMA_BLOCK
+*/
+#define ADC_VREF_INJECTED_USED          1U
+
+#if((ADC_VREF_INJECTED_USED == 1) && (ADC_ACQUISITION_MODE != ADC_MODE_DMA_BLOCK))
+	#error "ADC_VREF_INJECTED_USED requires ADC_MODE_DMA_BLOCK"
+#endif
+
+#if(ADC_VREF_INJECTED_USED == 1)
+/* Number of ranks in one regular scan (one frame): 4 EMG channels */
+#define ADC_SCAN_RANK_NUM               ((uint32_t)    4)
+#else
+/* Number of ranks in one regular scan (one frame): 4 EMG channels + Vref */
+#define ADC_SCAN_RANK_NUM               ((uint32_t)    5)
+#endif
+
+/* Rate of the tick that starts the injected Vref conversion: TIM3 interrupt, unit: Hz */
+#define ADC_VREF_TICK_RATE              ((uint32_t)  100)
+/* Injected Vref conversion rate after power on, unit: Hz */
+#define ADC_VREF_RATE_DEFAULT           ((uint32_t)   10)
+/* Macro function to determine whether the injected Vref conversion rate is correct */
+#define IS_ADC_VREF_RATE(RATE)          (((RATE) >= 1) && ((RATE) <= ADC_VREF_TICK_RATE))
+/* 
+	Maximum number of frames in one half of the ping-pong buffer,
+	the frames actually used depend on the sampling profile (one block is 10 ms of data)
+*/
+#define ADC_BLOCK_FRAME_MAX_NUM         ((uint32_t)  100)
+/* Size of the DMA ping-pong buffer: two blocks of ADC_BLOCK_FRAME_MAX_NUM frames */
+#define ADC_BLOCK_BUFFER_SIZE           ((uint32_t)(2*ADC_BLOCK_FRAME_MAX_NUM*ADC_SCAN_RANK_NUM))
+
+/* 
+	Oversampling ratio limits, the ratio must be a power of 2.
+	Every 4 times oversampling adds one effective bit: 4 - 13 bits, 16 - 14 bits, 64 - 15 bits, 256 - 16 bits
+*/
+#define ADC_OVERSAMPLING_RATIO_MIN      ((uint32_t)    1)
+#define ADC_OVERSAMPLING_RATIO_MAX      ((uint32_t)  256)
+/* Macro function to determine whether the oversampling ratio is correct */
+#define IS_ADC_OVERSAMPLING_RATIO(R)    (((R) >= ADC_OVERSAMPLING_RATIO_MIN) && ((R) <= ADC_OVERSAMPLING_RATIO_MAX) && (((R) & ((R) - 1)) == 0))
+
+/* Sampling profile used after power on */
+#define ADC_SAMPLE_PROFILE_DEFAULT      ADC_PROFILE_2KHZ
+/* Macro function to determine whether the sampling profile number is correct */
+#define IS_ADC_SAMPLE_PROFILE(ID)       ((uint32_t)(ID) < (uint32_t)ADC_PROFILE_NUM)
+/* Macro function to determine whether the channel number of a channel view is correct */
+#define IS_ADC_CHANNEL_ID(ID)           ((uint32_t)(ID) < (uint32_t)ADC_CHANNEL_ID_NUM)
 
 /**
   * @brief  Computation of voltage (unit: mV) from ADC measurement digital
@@ -67,6 +126,77 @@
 
 /* Data structure declaration-------------------------------------------------*/
 
+/* Sampling profile number: the sampling rate of every EMG channel */
+typedef enum
+{
+	ADC_PROFILE_2KHZ  = 0,
+	ADC_PROFILE_4KHZ  = 1,
+	ADC_PROFILE_8KHZ  = 2,
+	ADC_PROFILE_10KHZ = 3,
+#if(ADC_VREF_INJECTED_USED == 1)
+	/* Only fits in the sampling period when the scan carries the 4 EMG channels alone */
+	ADC_PROFILE_20KHZ = 4,
+#endif
+	ADC_PROFILE_NUM
+}ADC_SampleProfile_ID;
+
+/* 
+	Sampling profile: TIM2 period, ADC sample time and DMA block size are changed together
+*/
+typedef struct
+{
+	/* Nominal sampling rate of every channel, unit: Hz */
+	uint32_t Sample_Rate;
+	/* TIM2 prescaler and period, TIM2 TRGO starts one scan per period */
+	uint32_t TIM_Prescaler;
+	uint32_t TIM_Period;
+	/* Sample time of every rank, ADC_SAMPLETIME_xCYCLES */
+	uint32_t Sampling_Time;
+	/* Number of frames in one DMA block */
+	uint32_t Block_Frame_Num;
+}ADC_SampleProfile;
+
+/* Channel number of a channel view, the EMG sensors are ranks 1 - 4 of the scan */
+typedef enum
+{
+	ADC_CHANNEL_ID_SENSOR_1 = 0,
+	ADC_CHANNEL_ID_SENSOR_2 = 1,
+	ADC_CHANNEL_ID_SENSOR_3 = 2,
+	ADC_CHANNEL_ID_SENSOR_4 = 3,
+	ADC_CHANNEL_ID_VREF     = 4,
+	ADC_CHANNEL_ID_NUM
+}ADC_Channel_ID;
+
+/* 
+	Strided view of one channel in the latest calibrated data, sample i is p_Data[i*Stride]
+*/
+typedef struct
+{
+	/* First sample of the channel, unit: mV */
+	const uint16_t* p_Data;
+	/* Distance between two samples of the channel, in samples (0: the same value repeated) */
+	uint32_t Stride;
+	/* Number of samples of the channel */
+	uint32_t Length;
+}ADC_Channel_View;
+
+/* 
+	Oversampling and decimation state of one rank, kept across DMA blocks
+*/
+typedef struct
+{
+	/* Oversampling ratio: number of raw conversions summed for one output sample */
+	uint16_t Ratio;
+	/* Number of raw conversions already summed */
+	uint16_t Count;
+	/* Right shift applied to the sum, the result keeps 12 + log2(Ratio)/2 bits */
+	uint8_t  Shift;
+	/* Effective resolution of the output sample */
+	uint8_t  Bits;
+	/* Sum of the raw conversions */
+	uint32_t Sum;
+}ADC_Oversampling;
+
 /* Function declaration-------------------------------------------------------*/
 
 /* Initialize ADC related peripherals: ADC GPIO port and DMA channel */
@@ -83,6 +213,49 @@ t_FuncRet ADC_Get_SensorData_3(uint16_t* p_Sensor_V_Data);
 t_FuncRet ADC_Get_SensorData_4(uint16_t* p_Sensor_V_Data);
 /* Obtain the voltage of Vref */
 t_FuncRet ADC_Get_Vref(uint16_t* p_Vref);
+/* Obtain a view of one channel in the latest calibrated data, no data are copied */
+t_FuncRet ADC_Get_Channel_View(ADC_Channel_ID Channel, ADC_Channel_View* p_View);
+/* A block of DMA frames is complete and handed to the processing layer (weak, override in the Function layer) */
+void ADC_BlockReady_Callback(uint16_t* p_Block, uint32_t Frame_Num);
+
+/* Switch the sampling profile: TIM2 period, ADC sample time and DMA block size */
+t_FuncRet ADC_Set_SampleProfile(ADC_SampleProfile_ID Profile_ID);
+/* Request a sampling profile switch, it is applied later by ADC_SampleProfile_Process (interrupt safe) */
+t_FuncRet ADC_Request_SampleProfile(uint8_t Profile_ID);
+/* Apply a pending sampling profile switch, called in the main loop */
+t_FuncRet ADC_SampleProfile_Process(void);
+/* Return the current sampling profile number */
+ADC_SampleProfile_ID ADC_Get_SampleProfile(void);
+/* Return the sampling rate actually achieved by TIM2, unit: Hz */
+uint32_t ADC_Get_SampleRate(void);
+/* Return the number of frames in one DMA block */
+uint32_t ADC_Get_BlockFrameNum(void);
+
+/* Return the VDDA computed from the reference voltage of the latest block, unit: mV */
+uint16_t ADC_Get_VDDA(void);
+/* Return the calibrated voltage of Vref used for the latest block, unit: mV */
+uint16_t ADC_Get_VrefInt(void);
+#if(ADC_VREF_INJECTED_USED == 1)
+/* Set the injected Vref conversion rate */
+t_FuncRet ADC_Set_VrefRate(uint32_t Rate);
+/* Start an injected Vref conversion when it is due, called at ADC_VREF_TICK_RATE */
+void ADC_VrefInjected_Tick(void);
+#endif
+#if(ADC_ACQUISITION_MODE == ADC_MODE_DMA_BLOCK)
+/* Obtain the latest calibrated block (unit: mV) */
+t_FuncRet ADC_Get_CalibratedBlock(uint16_t** pp_Block, uint32_t* p_Frame_Num);
+/* Return the timestamp of the last frame of the latest block, unit: us */
+uint32_t ADC_Get_BlockTimestamp(void);
+#endif
+
+/* Set the oversampling ratio of one rank */
+t_FuncRet ADC_Set_Oversampling(uint8_t Rank, uint16_t Ratio);
+/* Return the effective resolution (bits) of the oversampled data of one rank */
+uint8_t ADC_Get_Oversampling_Bits(uint8_t Rank);
+/* Clear the partial sums of all ranks */
+void ADC_Oversampling_Reset(void);
+/* Oversample and decimate one rank of a DMA block */
+uint32_t ADC_Oversampling_Block(const uint16_t* p_Block, uint32_t Frame_Num, uint8_t Rank, uint16_t* p_DstBuff);
 
 #ifdef __cplusplus
 }
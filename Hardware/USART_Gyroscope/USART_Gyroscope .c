@@ -55,6 +55,13 @@ volatile static float gyro_x;
 volatile static float gyro_y;
 volatile static float gyro_z;
 
+/* Timestamp of the header byte of the packet being received, unit: us */
+static uint32_t Packet_Timestamp = 0;
+/* Timestamp of the latest packet of every kind, unit: us */
+volatile static uint32_t Acc_Timestamp       = 0;
+volatile static uint32_t Angle_Acc_Timestamp = 0;
+volatile static uint32_t Angle_Timestamp     = 0;
+
 /* Timing reading of gyroscope data with timer 4 interrupt (Fre = 20Hz) */
 extern TIM_HandleTypeDef htim4;
 
@@ -85,6 +92,12 @@ t_FuncRet CopeSerial2Data(unsigned char ucData)
 		return ret;
 	}
 	
+	// The packet is timestamped when its header byte arrives
+	if (ucRxCnt == 1)
+	{
+		Packet_Timestamp = GET_TIMESTAMP_US();
+	}
+	
 	// If the number of data is less than 11, return
 	if (ucRxCnt<11) 
 	{
@@ -104,9 +117,9 @@ t_FuncRet CopeSerial2Data(unsigned char ucData)
 				It needs to refer to "string.h" to copy the characters of the receive buffer into the data structure, 
 				so as to realize the data parsing
 			*/
-			case 0x51:	memcpy(&S_Acc,&ucRxBuffer[2],8);break;
-			case 0x52:	memcpy(&S_AngleAcc,&ucRxBuffer[2],8);break;
-			case 0x53:	memcpy(&S_Angle,&ucRxBuffer[2],8);break;
+			case 0x51:	memcpy(&S_Acc,&ucRxBuffer[2],8);Acc_Timestamp = Packet_Timestamp;break;
+			case 0x52:	memcpy(&S_AngleAcc,&ucRxBuffer[2],8);Angle_Acc_Timestamp = Packet_Timestamp;break;
+			case 0x53:	memcpy(&S_Angle,&ucRxBuffer[2],8);Angle_Timestamp = Packet_Timestamp;break;
 
 		}
 		
@@ -311,3 +324,36 @@ float Get_Zaxis_Angle_Acc(void)
 	gyro_z = (float)S_AngleAcc.Angle_Acc_DataBuf[2]/32768*2000;
 	return gyro_z;
 }
+
+/** 
+* @description: Return the timestamp of the latest acceleration packet
+* @param  {void} 
+* @return {{uint32_t} : Timestamp of the packet header, unit: us
+* @author: leeqingshui 
+*/
+uint32_t Get_Acc_Timestamp(void)
+{
+	return Acc_Timestamp;
+}
+
+/** 
+* @description: Return the timestamp of the latest Angle_Acc packet
+* @param  {void} 
+* @return {{uint32_t} : Timestamp of the packet header, unit: us
+* @author: leeqingshui 
+*/
+uint32_t Get_Angle_Acc_Timestamp(void)
+{
+	return Angle_Acc_Timestamp;
+}
+
+/** 
+* @description: Return the timestamp of the latest angel packet
+* @param  {void} 
+* @return {{uint32_t} : Timestamp of the packet header, unit: us
+* @author: leeqingshui 
+*/
+uint32_t Get_Angle_Timestamp(void)
+{
+	return Angle_Timestamp;
+}
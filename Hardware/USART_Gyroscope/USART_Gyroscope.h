@@ -72,6 +72,13 @@ float Get_Yaxis_Angle_Acc(void);
 /* Return the Z-axis Angle_Acc */
 float Get_Zaxis_Angle_Acc(void);
 
+/* Return the timestamp of the latest acceleration packet, unit: us */
+uint32_t Get_Acc_Timestamp(void);
+/* Return the timestamp of the latest Angle_Acc packet, unit: us */
+uint32_t Get_Angle_Acc_Timestamp(void);
+/* Return the timestamp of the latest angel packet, unit: us */
+uint32_t Get_Angle_Timestamp(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,6 +28,7 @@
     This file defines the structure and functions for sending data to the upmachine
 */
 #include "SendData_Function.h"
+#include "string.h"
 
 /* USER CODE END INCLUDE */
 
@@ -104,6 +105,18 @@ uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 
 /* USER CODE BEGIN PRIVATE_VARIABLES */
 
+/* 
+  Transmit queue over the slots of UserTxBufferFS, written in the main loop and the USB interrupt:
+  CDC_TxQueue_Num slots starting at CDC_TxQueue_Head hold data, the head one is in flight if CDC_TxQueue_Busy
+*/
+static uint16_t         CDC_TxQueue_Len[CDC_TX_QUEUE_NUM];
+static volatile uint8_t CDC_TxQueue_Head = 0;
+static volatile uint8_t CDC_TxQueue_Num  = 0;
+static volatile bool    CDC_TxQueue_Busy = (bool)FALSE;
+/* Writes refused because no slot had room, and the most slots ever holding data */
+static volatile uint32_t CDC_TxQueue_Drop      = 0;
+static volatile uint32_t CDC_TxQueue_HighWater = 0;
+
 /* USER CODE END PRIVATE_VARIABLES */
 
 /**
@@ -138,6 +151,8 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *pbuf, uint32_t *Len, uint8_t epnum);
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_DECLARATION */
 
+static void CDC_TxQueue_Start(void);
+
 /* USER CODE END PRIVATE_FUNCTIONS_DECLARATION */
 
 /**
@@ -164,6 +179,9 @@ static int8_t CDC_Init_FS(void)
   /* Set Application Buffers */
   USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
   USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  
+  /* A transfer cut by the reconnection never completes: send the queued data again from the head slot */
+  CDC_TxQueue_Busy = (bool)FALSE;
   return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -283,7 +301,33 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
     CDC_Transmit_FS(Buf,*Len);
   #endif
   
-  ret = AckSignal_Recv((uint8_t*)Buf);
+  /* 
+    Command frames go through the command parser, which keeps the frame split across packets;
+    any other packet is a single byte signal
+  */
+  if(Command_Recv((uint8_t*)Buf, *Len) == Operation_Fail)
+  {
+    ret = AckSignal_Recv((uint8_t*)Buf);
+    /* A sampling profile switch requested by the upper computer */
+    if(Buf[0] == SAMPLE_PROFILE_SIGNAL)
+    {
+      ret = SampleProfile_Recv((uint8_t*)Buf, *Len);
+    }
+    /* Credit granted by the upper computer for the batched ADC stream */
+    else if(Buf[0] == CREDIT_SIGNAL)
+    {
+      ret = Credit_Recv((uint8_t*)Buf, *Len);
+    }
+    /* Encoding of the batched ADC stream requested by the upper computer */
+    else if(Buf[0] == STREAM_ENCODING_SIGNAL)
+    {
+      ret = StreamEncoding_Recv((uint8_t*)Buf, *Len);
+    }
+  }
+  else
+  {
+    USBRecvSuccessFlag = (bool)TRUE;
+  }
   USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
   USBD_CDC_ReceivePacket(&hUsbDeviceFS);
   return (USBD_OK);
@@ -334,12 +378,130 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
   UNUSED(Buf);
   UNUSED(Len);
   UNUSED(epnum);
+  
+  /* 
+    The class driver has already ended a transfer of a multiple of the packet size with a zero length packet,
+    so the head slot is free and the next one can be sent without the host merging the two
+  */
+  if(CDC_TxQueue_Busy != (bool)FALSE)
+  {
+    CDC_TxQueue_Len[CDC_TxQueue_Head] = 0;
+    CDC_TxQueue_Head = (uint8_t)((CDC_TxQueue_Head + 1U) % CDC_TX_QUEUE_NUM);
+    CDC_TxQueue_Num--;
+    CDC_TxQueue_Busy = (bool)FALSE;
+  }
+  CDC_TxQueue_Start();
   /* USER CODE END 13 */
   return result;
 }
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/**
+  * @brief  CDC_Transmit_Queue_FS
+  *         Copy data into the transmit queue without waiting, the queue is sent in the background
+  *         and CDC_TransmitCplt_FS starts the next slot as soon as one is sent.
+  *         Small writes are packed into the last slot as long as it is not in flight, 
+  *         so the buffer of the caller can be reused at once.
+  *
+  * @param  Buf: Buffer of data to be sent
+  * @param  Len: Number of data to be sent (in bytes), CDC_TX_SLOT_SIZE at most
+  * @retval USBD_OK if the data is queued, USBD_BUSY if no slot has room (the data is dropped), else USBD_FAIL
+  */
+uint8_t CDC_Transmit_Queue_FS(uint8_t* Buf, uint16_t Len)
+{
+  uint8_t result = USBD_OK;
+  uint8_t Tail;
+  uint32_t PriMask;
+  
+  if((Len == 0) || (Len > CDC_TX_SLOT_SIZE))
+  {
+    return USBD_FAIL;
+  }
+  
+  /* The transmit complete interrupt must not see a half updated queue, the caller may already mask interrupts */
+  PriMask = __get_PRIMASK();
+  __disable_irq();
+  
+  Tail = (uint8_t)((CDC_TxQueue_Head + CDC_TxQueue_Num + CDC_TX_QUEUE_NUM - 1U) % CDC_TX_QUEUE_NUM);
+  
+  /* Pack into the last slot, unless it is in flight or full */
+  if((CDC_TxQueue_Num == 0) || ((CDC_TxQueue_Num == 1) && (CDC_TxQueue_Busy != (bool)FALSE)) || 
+     ((CDC_TxQueue_Len[Tail] + Len) > CDC_TX_SLOT_SIZE))
+  {
+    if(CDC_TxQueue_Num >= CDC_TX_QUEUE_NUM)
+    {
+      CDC_TxQueue_Drop++;
+      result = USBD_BUSY;
+    }
+    else
+    {
+      Tail = (uint8_t)((CDC_TxQueue_Head + CDC_TxQueue_Num) % CDC_TX_QUEUE_NUM);
+      CDC_TxQueue_Len[Tail] = 0;
+      CDC_TxQueue_Num++;
+      if(CDC_TxQueue_Num > CDC_TxQueue_HighWater)
+      {
+        CDC_TxQueue_HighWater = CDC_TxQueue_Num;
+      }
+    }
+  }
+  
+  if(result == USBD_OK)
+  {
+    memcpy(&UserTxBufferFS[Tail * CDC_TX_SLOT_SIZE + CDC_TxQueue_Len[Tail]], Buf, Len);
+    CDC_TxQueue_Len[Tail] += Len;
+    
+    CDC_TxQueue_Start();
+  }
+  
+  __set_PRIMASK(PriMask);
+  
+  return result;
+}
+
+/**
+  * @brief  CDC_Get_TxQueue_State
+  *         Return the state of the transmit queue
+  *
+  * @param  p_Depth: Number of slots holding data now, the one in flight included
+  * @param  p_Drop: Number of writes refused because no slot had room
+  * @param  p_High_Water: Most slots ever holding data
+  * @retval None
+  */
+void CDC_Get_TxQueue_State(uint32_t* p_Depth, uint32_t* p_Drop, uint32_t* p_High_Water)
+{
+  uint32_t PriMask = __get_PRIMASK();
+  
+  __disable_irq();
+  *p_Depth      = CDC_TxQueue_Num;
+  *p_Drop       = CDC_TxQueue_Drop;
+  *p_High_Water = CDC_TxQueue_HighWater;
+  __set_PRIMASK(PriMask);
+}
+
+/**
+  * @brief  CDC_TxQueue_Start
+  *         Send the head slot if nothing is in flight.
+  *         Called with the interrupts disabled or in the USB interrupt.
+  *         If the device is not configured yet the slot stays queued and is sent by the next write.
+  *
+  * @retval None
+  */
+static void CDC_TxQueue_Start(void)
+{
+  if((CDC_TxQueue_Busy != (bool)FALSE) || (CDC_TxQueue_Num == 0) || (hUsbDeviceFS.pClassData == NULL))
+  {
+    return;
+  }
+  
+  /* The slot being filled is packed no more once it is in flight */
+  USBD_CDC_SetTxBuffer(&hUsbDeviceFS, &UserTxBufferFS[CDC_TxQueue_Head * CDC_TX_SLOT_SIZE], CDC_TxQueue_Len[CDC_TxQueue_Head]);
+  if(USBD_CDC_TransmitPacket(&hUsbDeviceFS) == USBD_OK)
+  {
+    CDC_TxQueue_Busy = (bool)TRUE;
+  }
+}
+
 
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
@@ -54,6 +54,13 @@
 #define APP_RX_DATA_SIZE  2048
 #define APP_TX_DATA_SIZE  2048
 
+/* 
+  Transmit queue: UserTxBufferFS is split into CDC_TX_QUEUE_NUM slots sent one after the other,
+  one slot is in flight while the next ones are filled. A write never waits, it is refused if no slot has room
+*/
+#define CDC_TX_QUEUE_NUM  4U
+#define CDC_TX_SLOT_SIZE  (APP_TX_DATA_SIZE / CDC_TX_QUEUE_NUM)
+
 /* USER CODE END EXPORTED_DEFINES */
 
 /**
@@ -111,6 +118,11 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
 
+/* Copy data into the transmit queue, it is sent in the background */
+uint8_t CDC_Transmit_Queue_FS(uint8_t* Buf, uint16_t Len);
+/* Return the state of the transmit queue */
+void CDC_Get_TxQueue_State(uint32_t* p_Depth, uint32_t* p_Drop, uint32_t* p_High_Water);
+
 /* USER CODE END EXPORTED_FUNCTIONS */
 
 /**